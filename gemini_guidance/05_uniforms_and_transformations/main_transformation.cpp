@@ -7,6 +7,9 @@
 #include <sstream>
 #include <valarray>
 #include "gtc/type_ptr.hpp"
+#include "gtc/quaternion.hpp"
+#include "tools/culling.h"
+#include "tools/scene_graph.h"
 
 /**
  * Handles window resize.
@@ -52,7 +55,16 @@ std::string read_shader_file(const std::string& filename) {
     }
 }
 
-
+/**
+ * the camera's rotation in the world, the one glm::lookAt undoes: its -z along direction,
+ * its y as close to up as it gets
+ * @param direction where the camera looks, doesn't have to be normalized
+ */
+glm::quat look_rotation(const glm::vec3& direction, const glm::vec3& up) {
+    const glm::vec3 back = -glm::normalize(direction);
+    const glm::vec3 right = glm::normalize(glm::cross(up, back));
+    return glm::quat_cast(glm::mat3(right, glm::cross(back, right), back));
+}
 
 int main() {
 
@@ -161,7 +173,11 @@ int main() {
     glDeleteShader(vertex_shader);
     glDeleteShader(fragment_shader);
 
-    glm::mat4 model = glm::mat4(1.0f); // init identity matrix 4x4.
+    // the triangle and the camera are nodes, the model matrix is the triangle's world matrix and the view
+    // is the inverse of the camera's
+    tools::SceneGraph scene;
+    const tools::SceneGraph::NodeId triangle = scene.create();
+    const tools::SceneGraph::NodeId camera = scene.create();
     glm::vec3 camera_pos(0.0f, 0.0f, 3.0f);
     glm::vec3 camera_target(0.0f, 0.0f, 0.0f);
     glm::vec3 up_direction(0.0f, 1.0f, 0.0f); //meaning y+ is our world's "up".
@@ -171,6 +187,13 @@ int main() {
 
     float radius = 2.0f;
 
+    // every vertex is within sqrt(0.5) of the triangle's origin, the draw is skipped when that sphere is outside
+    // the view. this camera always looks at the origin so it never is, it's the test a bigger scene would need
+    const float bounding_radius = 0.71f;
+    tools::BoundingSpheres bounds;
+    bounds.add(glm::vec3(0.0f), bounding_radius);
+    std::vector<std::uint32_t> visible;
+
     while (!glfwWindowShouldClose(window)) {
 
         auto curr_time = static_cast<float>(glfwGetTime());
@@ -180,17 +203,19 @@ int main() {
         glClear(GL_COLOR_BUFFER_BIT);
 
 
-        int model_matrix_location = glGetUniformLocation(shader_program, "model");
-        glUniformMatrix4fv(model_matrix_location, 1, GL_FALSE, glm::value_ptr(model));
-
-        glm::mat4 rotation = glm::rotate(model, radians, glm::vec3(0.0f, 0.0f, 1.0f));
-        glUniformMatrix4fv(model_matrix_location, 1, GL_TRUE, glm::value_ptr(rotation));
-
+        scene.set_rotation(triangle, glm::angleAxis(radians, glm::vec3(0.0f, 0.0f, 1.0f)));
 
         float cam_x = radius * std::cos(radians);
         float cam_z = radius * std::cos(radians);
         camera_pos = glm::vec3(cam_x, 0.0f, cam_z);
-        glm::mat4 view_matrix = glm::lookAt(camera_pos, camera_target, up_direction);
+        scene.set_local(camera, {camera_pos, look_rotation(camera_target - camera_pos, up_direction)});
+
+        scene.update();
+
+        int model_matrix_location = glGetUniformLocation(shader_program, "model");
+        glUniformMatrix4fv(model_matrix_location, 1, GL_TRUE, glm::value_ptr(scene.world(triangle)));
+
+        glm::mat4 view_matrix = glm::inverse(scene.world(camera));
         int view_matrix_location = glGetUniformLocation(shader_program, "view");
         glUniformMatrix4fv(view_matrix_location, 1, GL_FALSE, glm::value_ptr(view_matrix));
 
@@ -199,9 +224,14 @@ int main() {
 
 
 
+        bounds.set(0, glm::vec3(scene.world(triangle)[3]), bounding_radius);
+        tools::cull(tools::extract_frustum(projection_matrix * view_matrix), bounds, visible);
+
         glUseProgram(shader_program);
-        glBindVertexArray(VAO);
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+        if (!visible.empty()) {
+            glBindVertexArray(VAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
 
         glfwSwapBuffers(window);
 
@@ -1,14 +1,35 @@
 #include "tools/window.h"
+#include "tools/render_thread.h"
 #include "tools/shader.h"
 #include <glad/glad.h>
+#include <cstring>
 #include <iostream>
 #include <glm/glm.hpp>
 
 
-int main() {
+int main(int argc, char** argv) {
     tools::Window window(600, 800, "Upside Down Triangle ( i lied. it's a star of david.)");
     std::cout << "C++ Standard: " << __cplusplus << std::endl;
 
+    // --record <file> saves the session, --replay <file> plays it back frame for frame, same animation every run.
+    // both step time by 1/60 s per frame, so the recording doesn't depend on how fast this machine was
+    tools::Input& input = window.input();
+    bool replay = false;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--record") == 0) {
+            input.set_fixed_step(1.0 / 60.0);
+            if (!input.start_recording(argv[++i])) {
+                return -1;
+            }
+        } else if (std::strcmp(argv[i], "--replay") == 0) {
+            input.set_fixed_step(1.0 / 60.0);
+            if (!input.start_replay(argv[++i])) {
+                return -1;
+            }
+            replay = true;
+        }
+    }
+
     float vertices[] = {
             -0.5f, -0.35, 0.0f,  // left
             0.5f, -0.35, 0.0f,  // right
@@ -29,25 +50,37 @@ int main() {
     auto shader = tools::Shader("resources/moving.glsl", "resources/moving.frag");
 
 
-    while (!window.should_close()) {
+    {
+        // the loop only computes and records, the render thread does the GL calls and waits on the swap
+        tools::RenderThread renderer(window);
+        while (!window.should_close()) {
+            input.update();
+            if (input.state().key_pressed(GLFW_KEY_ESCAPE) || (replay && !input.replaying())) {
+                window.close();
+            }
+            int time_value = input.time();
+            float w_value = std::sin(time_value) / 2.f + 0.5f;
 
 #pragma region rendering_region
-        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        shader.use();
-
-        int time_value = glfwGetTime();
-        float w_value = std::sin(time_value) / 2.f + 0.5f;
+            renderer.begin_frame().record([&shader, w_value] {
+                glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+                shader.use();
 
-        shader.set_uniform_data("newPos", w_value);
-        shader.set_uniform_data("opacity", w_value);
-
-        glDrawArrays(GL_TRIANGLES, 0, 3);
+                shader.set_uniform_data("newPos", w_value);
+                shader.set_uniform_data("opacity", w_value);
 
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+            });
 #pragma endregion
 
-        window.swap_buffers();
-        window.poll_events();
+            renderer.submit_frame();
+            window.poll_events();
+        }
+    } // the context is back on this thread for the cleanup
+
+    if (!input.stop_recording()) {
+        return -1;
     }
 
     glDeleteVertexArrays(1, &VAO);
@@ -1,6 +1,8 @@
 #include "tools/window.h"
 #include "tools/shader.h"
-#include "stb_image.h"
+#include "tools/texture.h"
+#include "tools/sampler_cache.h"
+#include "tools/shared_context_workers.h"
 #include <glad/glad.h>
 #include <iostream>
 
@@ -48,72 +50,60 @@ int main() {
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*) (6 * sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    unsigned int texture1,texture2;;
-    glGenTextures(1, &texture1);
-    glBindTexture(GL_TEXTURE_2D, texture1);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-
-    auto data = stbi_load("resources/wooden_container.jpg", &width, &height, &nrChannels, 0);
-
-    if (data) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        stbi_image_free(data);
-    } else {
-        std::cout << "Failed to load texture" << std::endl;
-        return -1;
-    }
-
-
-    glGenTextures(1, &texture2);
-    glBindTexture(GL_TEXTURE_2D, texture2);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-
-    stbi_set_flip_vertically_on_load(true);
-    auto data2 = stbi_load("resources/awesomeface.png", &width, &height, &nrChannels, 0);
-
-    if (data2) {
-        stbi_set_flip_vertically_on_load(false);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data2);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        stbi_image_free(data2);
-    } else {
-        std::cout << "Failed to load texture2" << std::endl;
-        return -1;
-    }
-
-
-
-
+    // the face is RGBA, the format now follows the channel count instead of being GL_RGB for both.
+    // no .srgb here, the default framebuffer isn't sRGB so the output would come out darker.
+    // decoding and uploading happen on a worker context, the window clears until both are there
+    tools::SharedContextWorkers workers(window);
+    auto texture1 = workers.create<tools::Texture>([] {
+        return std::make_unique<tools::Texture>("resources/wooden_container.jpg");
+    });
+    auto texture2 = workers.create<tools::Texture>([] {
+        return std::make_unique<tools::Texture>("resources/awesomeface.png",
+                                                tools::TextureDesc{.flip_vertically = true});
+    });
+    bool textures_ready = false;
+
+    // the wrapping lives in samplers now, the face is mirrored on s without touching its texture
+    tools::SamplerCache samplers;
+    const tools::SamplerDesc container_sampler{};
+    const tools::SamplerDesc face_sampler{.wrap_s = GL_MIRRORED_REPEAT};
 
     shader.use();
     shader.set_uniform_data<int>("texture1", 0);
     shader.set_uniform_data<int>("texture2", 1);
 
     while (!window.should_close()) {
+        // what poll_events() queued last frame, the same escape handling the raw glfw exercises poll for
+        window.input().update();
+        if (window.input().state().key_pressed(GLFW_KEY_ESCAPE)) {
+            window.close();
+        }
+
 #pragma region rendering_region
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture2);
-
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        if (!textures_ready && texture1->ready() && texture2->ready()) {
+            if (!texture1->get()->valid()) {
+                std::cout << "Failed to load texture" << std::endl;
+                return -1;
+            }
+            if (!texture2->get()->valid()) {
+                std::cout << "Failed to load texture2" << std::endl;
+                return -1;
+            }
+            textures_ready = true;
+        }
+
+        if (textures_ready) {
+            texture1->get()->bind(0);
+            samplers.bind(0, container_sampler);
+            texture2->get()->bind(1);
+            samplers.bind(1, face_sampler);
+
+            glBindVertexArray(VAO);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        }
 
 
 #pragma endregion
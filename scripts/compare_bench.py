@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""Compares two benchmark json files and flags slowdowns.
+
+usage: compare_bench.py <baseline.json> <current.json> [--threshold percent]
+
+takes micro_bench output (median ns per benchmark) and tools_bench output (median cpu/gpu ms per scene,
+call counts per frame). a timing more than --threshold percent (default 5) slower than the baseline is a
+regression, and so is any increase in the call counts, those are deterministic.
+exits 1 if anything regressed, so CI can fail on it.
+"""
+import argparse
+import json
+import sys
+
+
+def metrics(document):
+    """name -> (value, is_count) for everything worth comparing, lower is better for all of them"""
+    values = {}
+    for benchmark in document.get("benchmarks", []):
+        values[benchmark["name"]] = (benchmark["median_ns"], False)
+    for scene in document.get("scenes", []):
+        if not scene.get("ok", True):
+            continue
+        name = scene["name"]
+        values[name + "/cpu_ms"] = (scene["cpu_ms"]["median"], False)
+        values[name + "/gpu_ms"] = (scene["gpu_ms"]["median"], False)
+        for count in ("draw_calls", "state_changes", "uniform_updates"):
+            values[name + "/" + count] = (scene[count], True)
+    return values
+
+
+def main():
+    parser = argparse.ArgumentParser(description="flags benchmark regressions between two runs")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=5.0, help="allowed slowdown in percent")
+    arguments = parser.parse_args()
+
+    with open(arguments.baseline) as file:
+        baseline = metrics(json.load(file))
+    with open(arguments.current) as file:
+        current = metrics(json.load(file))
+
+    regressions = 0
+    width = max((len(name) for name in current), default=0)
+    for name, (value, is_count) in current.items():
+        if name not in baseline:
+            print(f"{name:<{width}}  {value:>14.6g}  (new)")
+            continue
+        old = baseline[name][0]
+        change = (value - old) / old * 100.0 if old > 0 else 0.0
+        regressed = value > old if is_count else change > arguments.threshold
+        regressions += regressed
+        flag = "  REGRESSION" if regressed else ""
+        print(f"{name:<{width}}  {old:>14.6g} -> {value:>14.6g}  {change:+7.2f}%{flag}")
+
+    for name in sorted(baseline.keys() - current.keys()):
+        print(f"{name:<{width}}  (missing from current run)")
+
+    if regressions:
+        print(f"\n{regressions} regression(s) over {arguments.threshold}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,5 +1,5 @@
    sudo apt update
-   sudo apt install build-essential cmake libgl-dev mesa-utils libglfw3-dev
+   sudo apt install build-essential cmake libgl-dev libegl-dev mesa-utils libglfw3-dev
    sudo apt install libxi-dev libxxf86vm-dev libxcursor-dev libxinerama-dev libxrandr-dev
    sudo add-apt-repository ppa:kisak/kisak-mesa
    sudo apt update
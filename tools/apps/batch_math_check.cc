@@ -0,0 +1,183 @@
+#include "tools/batch_math.h"
+#include "tools/scene_graph.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * Batch math check: runs multiply, compose and transform_points on random input through the AVX2 path and
+ * the scalar path and compares every result against a plain glm loop, bit for bit (batch_math.h promises
+ * identical results, not just close ones). every count from 0 to 17 is run too, for the tails after the
+ * last full register, and each kernel once in place.
+ * usage: batch_math_check [--count n] [--seed s]
+ * exits -1 on any mismatch.
+ */
+
+namespace {
+
+struct Options {
+    std::size_t count = 100000;
+    unsigned int seed = 1;
+};
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--count") == 0 && has_value) {
+            options.count = static_cast<std::size_t>(std::atoll(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+            options.seed = static_cast<unsigned int>(std::atoi(argv[++i]));
+        } else {
+            std::cerr << "unknown option: " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+class Random {
+public:
+    explicit Random(unsigned int seed) : _engine(seed) {}
+
+    /**
+     * magnitudes from 1e-3 to 1e3, so rounding actually happens in every add
+     */
+    float value() {
+        const float magnitude = std::pow(10.0f, std::uniform_real_distribution<float>(-3.0f, 3.0f)(_engine));
+        return std::uniform_real_distribution<float>(-1.0f, 1.0f)(_engine) * magnitude;
+    }
+
+    glm::vec3 vec3() {
+        return glm::vec3(value(), value(), value());
+    }
+
+    glm::mat4 mat4() {
+        glm::mat4 matrix;
+        for (int c = 0; c < 4; ++c) {
+            matrix[c] = glm::vec4(value(), value(), value(), value());
+        }
+        return matrix;
+    }
+
+    tools::Transform transform() {
+        std::normal_distribution<float> normal;
+        const glm::quat rotation = glm::normalize(glm::quat(normal(_engine), normal(_engine), normal(_engine),
+                                                            normal(_engine)));
+        return {vec3(), rotation, vec3()};
+    }
+
+private:
+    std::mt19937 _engine;
+};
+
+/**
+ * @return the number of elements whose bytes differ, the first one is printed
+ */
+template<typename T>
+std::size_t count_mismatches(const std::string& what, std::span<const T> actual, std::span<const T> expected) {
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        if (std::memcmp(&actual[i], &expected[i], sizeof(T)) != 0) {
+            if (mismatches == 0) {
+                std::cerr << what << ": first mismatch at " << i << " of " << expected.size() << std::endl;
+            }
+            ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
+struct Input {
+    glm::mat4 left;
+    std::vector<glm::mat4> matrices;
+    std::vector<tools::Transform> transforms;
+    std::vector<glm::vec3> points;
+};
+
+/**
+ * the three kernels on the first `count` elements, out of place and in place
+ */
+std::size_t check(const std::string& path, const Input& input, std::size_t count) {
+    const std::string suffix = " (" + path + ", " + std::to_string(count) + ")";
+    std::size_t mismatches = 0;
+
+    const std::span<const glm::mat4> matrices(input.matrices.data(), count);
+    std::vector<glm::mat4> expected_matrices(count);
+    std::vector<glm::mat4> actual_matrices(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        expected_matrices[i] = input.left * matrices[i];
+    }
+    tools::multiply(input.left, matrices, actual_matrices);
+    mismatches += count_mismatches<glm::mat4>("multiply" + suffix, actual_matrices, expected_matrices);
+    actual_matrices.assign(matrices.begin(), matrices.end());
+    tools::multiply(input.left, actual_matrices, actual_matrices);
+    mismatches += count_mismatches<glm::mat4>("multiply in place" + suffix, actual_matrices, expected_matrices);
+
+    const std::span<const tools::Transform> transforms(input.transforms.data(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        expected_matrices[i] = tools::to_matrix(transforms[i]);
+    }
+    tools::compose(transforms, actual_matrices);
+    mismatches += count_mismatches<glm::mat4>("compose" + suffix, actual_matrices, expected_matrices);
+
+    const std::span<const glm::vec3> points(input.points.data(), count);
+    std::vector<glm::vec3> expected_points(count);
+    std::vector<glm::vec3> actual_points(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        expected_points[i] = glm::vec3(input.left * glm::vec4(points[i], 1.0f));
+    }
+    tools::transform_points(input.left, points, actual_points);
+    mismatches += count_mismatches<glm::vec3>("transform_points" + suffix, actual_points, expected_points);
+    actual_points.assign(points.begin(), points.end());
+    tools::transform_points(input.left, actual_points, actual_points);
+    mismatches += count_mismatches<glm::vec3>("transform_points in place" + suffix, actual_points,
+                                              expected_points);
+
+    return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--count n] [--seed s]" << std::endl;
+        return -1;
+    }
+
+    Random random(options.seed);
+    Input input{random.mat4(), {}, {}, {}};
+    const std::size_t count = std::max<std::size_t>(options.count, 17);
+    for (std::size_t i = 0; i < count; ++i) {
+        input.matrices.push_back(random.mat4());
+        input.transforms.push_back(random.transform());
+        input.points.push_back(random.vec3());
+    }
+
+    std::size_t mismatches = 0;
+    for (const bool avx2: {true, false}) {
+        tools::set_batch_math_avx2(avx2);
+        if (avx2 && !tools::batch_math_avx2()) {
+            std::cout << "no AVX2 on this CPU, checking the scalar path only" << std::endl;
+            continue;
+        }
+        const std::string path = avx2 ? "avx2" : "scalar";
+        std::size_t path_mismatches = check(path, input, count);
+        for (std::size_t small = 0; small <= 17; ++small) {
+            path_mismatches += check(path, input, small);
+        }
+        std::cout << path << ": " << path_mismatches << " mismatches" << std::endl;
+        mismatches += path_mismatches;
+    }
+    tools::set_batch_math_avx2(true);
+
+    return mismatches == 0 ? 0 : -1;
+}
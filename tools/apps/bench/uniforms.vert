@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+// one uniform of every type Shader::set_uniform_data takes, all used so none get optimized out
+uniform int count;
+uniform float scale;
+uniform vec2 offset;
+uniform vec3 tint;
+uniform vec4 bias;
+uniform mat3 normal_matrix;
+uniform mat4 transform;
+
+out vec3 colour;
+
+void main()
+{
+    gl_Position = transform * vec4(aPos * scale, 1.0) + bias + vec4(offset, float(count), 0.0);
+    colour = normal_matrix * tint;
+}
@@ -0,0 +1,404 @@
+#include "demo_scenes.hh"
+#include "tools/sampler_cache.h"
+#include "tools/shader.h"
+#include "tools/software_rasterizer.h"
+#include "tools/texture.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <numeric>
+
+namespace demo {
+
+namespace {
+
+// vertex data shared by the GL and software scenes. attribute sizes: triangle {3}, coloured {3, 3}, the rest {3, 3, 2}
+const std::vector<float> triangle_vertices = {-0.5f, -0.5f, 0.0f, 0.5f, -0.5f, 0.0f, 0.0f, 0.5f, 0.0f};
+
+const std::vector<float> coloured_triangle_vertices = {-0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f,
+                                                       0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f,
+                                                       0.0f, 0.5f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+const std::vector<float> square_vertices = {-0.25f, -0.25f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.1f,
+                                            0.25f, -0.25f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.1f,
+                                            0.25f, 0.25f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.1f,
+                                            -0.25f, 0.25f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.1f};
+const std::vector<unsigned int> square_indices = {0, 1, 2, 0, 2, 3};
+
+const std::vector<float> blending_vertices = {0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 2.0f, 2.0f,
+                                              0.5f, -0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 2.0f, 0.0f,
+                                              -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
+                                              -0.5f, 0.5f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 2.0f};
+const std::vector<unsigned int> blending_indices = {0, 1, 3, 1, 2, 3};
+
+const glm::vec4 demo_clear_colour(0.0f, 0.3f, 0.3f, 1.0f);
+const glm::vec4 blending_clear_colour(0.2f, 0.3f, 0.3f, 1.0f);
+
+/**
+ * one VAO with interleaved float attributes, as the demos set them up
+ */
+class Geometry {
+public:
+    /**
+     * @param attributes component count per attribute, locations 0, 1, ...
+     */
+    Geometry(const std::vector<float>& vertices, const std::vector<unsigned int>& indices,
+             const std::vector<int>& attributes) : _index_count(static_cast<int>(indices.size())) {
+        glGenVertexArrays(1, &_vao);
+        glGenBuffers(1, &_vbo);
+        glBindVertexArray(_vao);
+
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(float)), vertices.data(),
+                     GL_STATIC_DRAW);
+
+        if (!indices.empty()) {
+            glGenBuffers(1, &_ebo);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(unsigned int)),
+                         indices.data(), GL_STATIC_DRAW);
+        }
+
+        const int stride = std::accumulate(attributes.begin(), attributes.end(), 0);
+        int offset = 0;
+        for (std::size_t location = 0; location < attributes.size(); ++location) {
+            glVertexAttribPointer(static_cast<GLuint>(location), attributes[location], GL_FLOAT, GL_FALSE,
+                                  stride * static_cast<int>(sizeof(float)),
+                                  reinterpret_cast<void*>(offset * sizeof(float)));
+            glEnableVertexAttribArray(static_cast<GLuint>(location));
+            offset += attributes[location];
+        }
+        glBindVertexArray(0);
+    }
+
+    ~Geometry() {
+        glDeleteVertexArrays(1, &_vao);
+        glDeleteBuffers(1, &_vbo);
+        glDeleteBuffers(1, &_ebo);
+    }
+
+    Geometry(const Geometry&) = delete;
+
+    Geometry& operator=(const Geometry&) = delete;
+
+    unsigned int vao() const {
+        return _vao;
+    }
+
+    int index_count() const {
+        return _index_count;
+    }
+
+private:
+    unsigned int _vao = 0;
+    unsigned int _vbo = 0;
+    unsigned int _ebo = 0;
+    int _index_count;
+};
+
+/**
+ * 02_triangle, orange triangle
+ */
+class TriangleScene : public Scene {
+public:
+    explicit TriangleScene(const std::string& root)
+            : _shader(root + "/tools/apps/bench/triangle.vert", root + "/tools/apps/bench/triangle.frag"),
+              _geometry(triangle_vertices, {}, {3}) {}
+
+    void render(int) override {
+        glClearColor(demo_clear_colour.x, demo_clear_colour.y, demo_clear_colour.z, demo_clear_colour.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+        _shader.use();
+        glBindVertexArray(_geometry.vao());
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+private:
+    tools::Shader _shader;
+    Geometry _geometry;
+};
+
+/**
+ * 03_coloured_triangle, per vertex colours
+ */
+class ColouredTriangleScene : public Scene {
+public:
+    explicit ColouredTriangleScene(const std::string& root)
+            : _shader(root + "/gemini_guidance/03_coloured_triangle/shader_source.glsl",
+                      root + "/gemini_guidance/03_coloured_triangle/fragment_shader_source.glsl"),
+              _geometry(coloured_triangle_vertices, {}, {3, 3}) {}
+
+    void render(int) override {
+        glClearColor(demo_clear_colour.x, demo_clear_colour.y, demo_clear_colour.z, demo_clear_colour.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+        _shader.use();
+        glBindVertexArray(_geometry.vao());
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+private:
+    tools::Shader _shader;
+    Geometry _geometry;
+};
+
+/**
+ * 04_rotating_triangle, offset and accumulated rotation uploaded every frame
+ */
+class RotatingTriangleScene : public Scene {
+public:
+    explicit RotatingTriangleScene(const std::string& root)
+            : _shader(root + "/gemini_guidance/04_rotating_triangle/shader_source.glsl",
+                      root + "/gemini_guidance/04_rotating_triangle/fragment_shader_source.glsl"),
+              _geometry(coloured_triangle_vertices, {}, {3, 3}) {}
+
+    void render(int frame) override {
+        const float time = static_cast<float>(frame) / 60.0f;
+
+        glClearColor(demo_clear_colour.x, demo_clear_colour.y, demo_clear_colour.z, demo_clear_colour.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        // set_uniform_data looks the location up on every call, like the demo does.
+        // the demo uploads with transpose = true, hence the transpose
+        _shader.use();
+        _shader.set_uniform_data<float>("xOffset", std::sin(time));
+        _transform = glm::rotate(_transform, glm::radians(time), glm::vec3(0.0f, 0.0f, 1.0f));
+        _shader.set_uniform_data<glm::mat4>("transform", glm::transpose(_transform));
+
+        glBindVertexArray(_geometry.vao());
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+private:
+    tools::Shader _shader;
+    Geometry _geometry;
+    glm::mat4 _transform{1.0f};
+};
+
+/**
+ * 07_textured_square, an indexed quad
+ */
+class TexturedSquareScene : public Scene {
+public:
+    explicit TexturedSquareScene(const std::string& root)
+            : _shader(root + "/gemini_guidance/07_textured_square/shader_source.glsl",
+                      root + "/gemini_guidance/07_textured_square/fragment_shader_source.glsl"),
+              _geometry(square_vertices, square_indices, {3, 3, 2}) {}
+
+    void render(int) override {
+        glClearColor(demo_clear_colour.x, demo_clear_colour.y, demo_clear_colour.z, demo_clear_colour.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+        _shader.use();
+        glBindVertexArray(_geometry.vao());
+        glDrawElements(GL_TRIANGLES, _geometry.index_count(), GL_UNSIGNED_INT, nullptr);
+    }
+
+private:
+    tools::Shader _shader;
+    Geometry _geometry;
+};
+
+/**
+ * learn_opengl 04_textures/03_texture_blending, two textures with their own samplers
+ */
+class TextureBlendingScene : public Scene {
+public:
+    explicit TextureBlendingScene(const std::string& root)
+            : _shader(root + "/learn_opengl/excercises/04_textures/shaders/vertex.vert",
+                      root + "/learn_opengl/excercises/04_textures/shaders/fragment_two_textures.frag"),
+              _geometry(blending_vertices, blending_indices, {3, 3, 2}),
+              _container(root + "/learn_opengl/excercises/04_textures/resources/wooden_container.jpg"),
+              _face(root + "/learn_opengl/excercises/04_textures/resources/awesomeface.png",
+                    {.flip_vertically = true}) {
+        _shader.use();
+        _shader.set_uniform_data<int>("texture1", 0);
+        _shader.set_uniform_data<int>("texture2", 1);
+    }
+
+    bool valid() const override {
+        return _container.valid() && _face.valid();
+    }
+
+    void render(int) override {
+        glClearColor(blending_clear_colour.x, blending_clear_colour.y, blending_clear_colour.z,
+                     blending_clear_colour.w);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        _shader.use();
+        _container.bind(0);
+        _samplers.bind(0, _container_sampler);
+        _face.bind(1);
+        _samplers.bind(1, _face_sampler);
+
+        glBindVertexArray(_geometry.vao());
+        glDrawElements(GL_TRIANGLES, _geometry.index_count(), GL_UNSIGNED_INT, nullptr);
+    }
+
+private:
+    tools::Shader _shader;
+    Geometry _geometry;
+    tools::Texture _container;
+    tools::Texture _face;
+    tools::SamplerCache _samplers;
+    tools::SamplerDesc _container_sampler{};
+    tools::SamplerDesc _face_sampler{.wrap_s = GL_MIRRORED_REPEAT};
+};
+
+template<typename T>
+std::unique_ptr<Scene> make_scene(const std::string& root) {
+    return std::make_unique<T>(root);
+}
+
+/**
+ * interleaved floats to RasterVertex: attribute 0 is the position, 1 the colour, 2 the uv
+ */
+std::vector<tools::RasterVertex> raster_vertices(const std::vector<float>& data, const std::vector<int>& attributes) {
+    const auto stride = static_cast<std::size_t>(std::accumulate(attributes.begin(), attributes.end(), 0));
+    std::vector<tools::RasterVertex> vertices(data.size() / stride);
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const float* source = &data[i * stride];
+        for (std::size_t attribute = 0; attribute < attributes.size(); ++attribute) {
+            float* destination = attribute == 0 ? &vertices[i].position.x
+                                                : attribute == 1 ? &vertices[i].colour.x : &vertices[i].uv.x;
+            std::copy(source, source + attributes[attribute], destination);
+            source += attributes[attribute];
+        }
+    }
+    return vertices;
+}
+
+/**
+ * the scenes without shaders: the vertex shader is the draw's transform (plus any CPU side work),
+ * the fragment shader one of tools::Shading
+ */
+class SoftwareTriangleScene : public SoftwareScene {
+public:
+    explicit SoftwareTriangleScene(const std::string&) : _vertices(raster_vertices(triangle_vertices, {3})) {
+        _draw.shading = tools::Shading::constant;
+        _draw.colour = glm::vec4(1.0f, 0.5f, 0.2f, 1.0f);
+    }
+
+    void render(tools::SoftwareRasterizer& rasterizer, int) override {
+        rasterizer.clear(demo_clear_colour);
+        rasterizer.draw(_vertices, {}, _draw);
+    }
+
+private:
+    std::vector<tools::RasterVertex> _vertices;
+    tools::RasterDraw _draw;
+};
+
+class SoftwareColouredTriangleScene : public SoftwareScene {
+public:
+    explicit SoftwareColouredTriangleScene(const std::string&)
+            : _vertices(raster_vertices(coloured_triangle_vertices, {3, 3})) {}
+
+    void render(tools::SoftwareRasterizer& rasterizer, int) override {
+        rasterizer.clear(demo_clear_colour);
+        rasterizer.draw(_vertices, {}, tools::RasterDraw{});
+    }
+
+private:
+    std::vector<tools::RasterVertex> _vertices;
+};
+
+class SoftwareRotatingTriangleScene : public SoftwareScene {
+public:
+    explicit SoftwareRotatingTriangleScene(const std::string&)
+            : _vertices(raster_vertices(coloured_triangle_vertices, {3, 3})), _moved(_vertices) {}
+
+    void render(tools::SoftwareRasterizer& rasterizer, int frame) override {
+        const float time = static_cast<float>(frame) / 60.0f;
+        rasterizer.clear(demo_clear_colour);
+
+        // the vertex shader's xOffset, then the same accumulated rotation as the GL scene
+        for (std::size_t i = 0; i < _vertices.size(); ++i) {
+            _moved[i].position.x = _vertices[i].position.x + std::sin(time);
+        }
+        _transform = glm::rotate(_transform, glm::radians(time), glm::vec3(0.0f, 0.0f, 1.0f));
+        tools::RasterDraw draw;
+        draw.transform = glm::transpose(_transform);
+        rasterizer.draw(_moved, {}, draw);
+    }
+
+private:
+    std::vector<tools::RasterVertex> _vertices;
+    std::vector<tools::RasterVertex> _moved;
+    glm::mat4 _transform{1.0f};
+};
+
+class SoftwareTexturedSquareScene : public SoftwareScene {
+public:
+    explicit SoftwareTexturedSquareScene(const std::string&)
+            : _vertices(raster_vertices(square_vertices, {3, 3, 2})) {}
+
+    void render(tools::SoftwareRasterizer& rasterizer, int) override {
+        rasterizer.clear(demo_clear_colour);
+        rasterizer.draw(_vertices, square_indices, tools::RasterDraw{});
+    }
+
+private:
+    std::vector<tools::RasterVertex> _vertices;
+};
+
+class SoftwareTextureBlendingScene : public SoftwareScene {
+public:
+    explicit SoftwareTextureBlendingScene(const std::string& root)
+            : _vertices(raster_vertices(blending_vertices, {3, 3, 2})) {
+        const std::string resources = root + "/learn_opengl/excercises/04_textures/resources/";
+        _valid = tools::load_image(resources + "wooden_container.jpg", _container) &&
+                 tools::load_image(resources + "awesomeface.png", _face, true);
+        _draw.shading = tools::Shading::texture_mix;
+        _draw.textures[0] = &_container;
+        _draw.textures[1] = &_face;
+        _draw.samplers[1].wrap_s = GL_MIRRORED_REPEAT;
+        _draw.mix = 0.2f;
+    }
+
+    bool valid() const override {
+        return _valid;
+    }
+
+    void render(tools::SoftwareRasterizer& rasterizer, int) override {
+        rasterizer.clear(blending_clear_colour);
+        rasterizer.draw(_vertices, blending_indices, _draw);
+    }
+
+private:
+    std::vector<tools::RasterVertex> _vertices;
+    tools::Image _container;
+    tools::Image _face;
+    bool _valid;
+    tools::RasterDraw _draw;
+};
+
+template<typename T>
+std::unique_ptr<SoftwareScene> make_software_scene(const std::string& root) {
+    return std::make_unique<T>(root);
+}
+
+} // namespace
+
+const std::vector<SceneEntry>& scenes() {
+    static const std::vector<SceneEntry> entries = {
+            {"triangle", make_scene<TriangleScene>},
+            {"coloured_triangle", make_scene<ColouredTriangleScene>},
+            {"rotating_triangle", make_scene<RotatingTriangleScene>},
+            {"textured_square", make_scene<TexturedSquareScene>},
+            {"texture_blending", make_scene<TextureBlendingScene>},
+    };
+    return entries;
+}
+
+const std::vector<SoftwareSceneEntry>& software_scenes() {
+    static const std::vector<SoftwareSceneEntry> entries = {
+            {"triangle", make_software_scene<SoftwareTriangleScene>},
+            {"coloured_triangle", make_software_scene<SoftwareColouredTriangleScene>},
+            {"rotating_triangle", make_software_scene<SoftwareRotatingTriangleScene>},
+            {"textured_square", make_software_scene<SoftwareTexturedSquareScene>},
+            {"texture_blending", make_software_scene<SoftwareTextureBlendingScene>},
+    };
+    return entries;
+}
+
+} // demo
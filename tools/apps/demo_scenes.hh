@@ -0,0 +1,69 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace tools {
+class SoftwareRasterizer;
+} // tools
+
+// the demo scenes, rebuilt as objects so tools_bench and golden_images can run them headlessly
+namespace demo {
+
+/**
+ * one demo's setup and render loop body. needs a current context, renders into whatever is bound
+ */
+class Scene {
+public:
+    virtual ~Scene() = default;
+
+    virtual bool valid() const {
+        return true;
+    }
+
+    virtual void render(int frame) = 0;
+};
+
+struct SceneEntry {
+    const char* name;
+    std::function<std::unique_ptr<Scene>(const std::string& root)> create; // root: the source tree
+};
+
+/**
+ * triangle, coloured_triangle, rotating_triangle, textured_square, texture_blending.
+ * they use the demos' own shader and texture files, read from the source tree, so a change to a demo's
+ * shaders shows up in the benchmarks and golden images. `frame` stands in for the clock (frame / 60 seconds),
+ * so the animated scenes draw the same thing on every run.
+ */
+const std::vector<SceneEntry>& scenes();
+
+/**
+ * the same scene drawn by tools::SoftwareRasterizer, no GL needed
+ */
+class SoftwareScene {
+public:
+    virtual ~SoftwareScene() = default;
+
+    virtual bool valid() const {
+        return true;
+    }
+
+    /**
+     * records the frame, the caller finishes the rasterizer
+     */
+    virtual void render(tools::SoftwareRasterizer& rasterizer, int frame) = 0;
+};
+
+struct SoftwareSceneEntry {
+    const char* name;
+    std::function<std::unique_ptr<SoftwareScene>(const std::string& root)> create;
+};
+
+/**
+ * the scenes() above, same names, drawn on the CPU. texture_blending samples bilinear without mipmaps,
+ * so it matches the GL one only where the textures aren't minified
+ */
+const std::vector<SoftwareSceneEntry>& software_scenes();
+
+} // demo
@@ -0,0 +1,189 @@
+#include "demo_scenes.hh"
+#include "tools/frame_capture.h"
+#include "tools/headless_context.h"
+#include "tools/image_compare.h"
+#include "tools/png.h"
+#include "tools/render_target.h"
+#include "tools/software_rasterizer.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Golden image check: renders every demo scene headlessly and compares the last frame against the
+ * reference PNG in tools/apps/golden/. run it before and after optimizations that shouldn't change the output
+ * (batching, state caching, texture formats...).
+ * usage: golden_images [--update] [--software] [--scene name] [--threshold t] [--tolerance fraction] [--root dir]
+ *                      [--output-dir dir]
+ *
+ * a pixel differs when its perceptual delta (compare_images) is over --threshold, a scene fails when more than
+ * --tolerance of its pixels differ. that absorbs drivers rounding and filtering a little differently.
+ * failed scenes get <name>.actual.png and <name>.diff.png in --output-dir.
+ * --update rewrites the references from this run instead of comparing, look at them before committing.
+ * --software draws the scenes with tools::SoftwareRasterizer instead, no GL or display needed, against the
+ * references in tools/apps/golden/software/. that output doesn't depend on the driver, so any difference is a change.
+ * exits -1 if any scene failed.
+ */
+
+namespace {
+
+// the references are this size and this many frames in, changing either means --update
+constexpr int width = 320;
+constexpr int height = 240;
+constexpr int frames = 30;
+
+struct Options {
+    bool update = false;
+    bool software = false;
+    std::string scene;
+    double threshold = 0.1;
+    double tolerance = 0.001;
+    std::string root = TOOLS_BENCH_SOURCE_DIR;
+    std::string output_dir = ".";
+};
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--update") == 0) {
+            options.update = true;
+        } else if (std::strcmp(argv[i], "--software") == 0) {
+            options.software = true;
+        } else if (std::strcmp(argv[i], "--scene") == 0 && has_value) {
+            options.scene = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && has_value) {
+            options.threshold = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--tolerance") == 0 && has_value) {
+            options.tolerance = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--root") == 0 && has_value) {
+            options.root = argv[++i];
+        } else if (std::strcmp(argv[i], "--output-dir") == 0 && has_value) {
+            options.output_dir = argv[++i];
+        } else {
+            std::cerr << "unknown option: " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @return false if the image doesn't match its reference
+ */
+bool check_image(const std::string& name, const tools::Image& actual, const Options& options) {
+    const std::string reference_path =
+            options.root + "/tools/apps/golden/" + (options.software ? "software/" : "") + name + ".png";
+    if (options.update) {
+        const bool written = tools::write_png(reference_path, actual);
+        std::cout << name << ": " << (written ? "updated " : "FAILED to write ") << reference_path << std::endl;
+        return written;
+    }
+
+    tools::Image reference;
+    if (!tools::load_image(reference_path, reference, false, 4)) {
+        std::cout << name << ": no reference, run with --update to create it" << std::endl;
+        return false;
+    }
+
+    tools::Image diff;
+    const tools::ImageDifference difference = tools::compare_images(actual, reference, options.threshold, &diff);
+    const bool passed = difference.same_size && difference.differing_fraction <= options.tolerance;
+    std::cout << name << ": " << (passed ? "ok" : "FAILED") << ", " << difference.differing_pixels
+              << " pixels differ (" << difference.differing_fraction * 100.0 << "%), max delta "
+              << difference.max_delta << ", mean delta " << difference.mean_delta << std::endl;
+
+    if (!passed) {
+        const std::string prefix = options.output_dir + "/" + name;
+        tools::write_png(prefix + ".actual.png", actual);
+        if (difference.same_size) {
+            tools::write_png(prefix + ".diff.png", diff);
+        }
+    }
+    return passed;
+}
+
+/**
+ * @return false if the scene couldn't be set up or doesn't match its reference
+ */
+bool check_scene(const demo::SceneEntry& entry, const Options& options, const tools::RenderTarget& target) {
+    std::unique_ptr<demo::Scene> scene = entry.create(options.root);
+    if (!scene->valid()) {
+        std::cerr << "ERROR::GOLDEN::SCENE_SETUP_FAILED: " << entry.name << std::endl;
+        return false;
+    }
+
+    target.bind();
+    for (int frame = 0; frame < frames; ++frame) {
+        scene->render(frame);
+    }
+    return check_image(entry.name, tools::capture_framebuffer(target.framebuffer(), width, height), options);
+}
+
+bool check_software_scene(const demo::SoftwareSceneEntry& entry, const Options& options) {
+    std::unique_ptr<demo::SoftwareScene> scene = entry.create(options.root);
+    if (!scene->valid()) {
+        std::cerr << "ERROR::GOLDEN::SCENE_SETUP_FAILED: " << entry.name << std::endl;
+        return false;
+    }
+
+    tools::SoftwareRasterizer rasterizer(width, height);
+    for (int frame = 0; frame < frames; ++frame) {
+        scene->render(rasterizer, frame);
+        rasterizer.finish();
+    }
+    return check_image(entry.name, rasterizer.image(), options);
+}
+
+/**
+ * @return the number of failed scenes, -1 if the name matched none
+ */
+template<typename Entry, typename Check>
+int check_scenes(const std::vector<Entry>& entries, const Options& options, Check check) {
+    int checked = 0;
+    int failed = 0;
+    for (const Entry& entry: entries) {
+        if (!options.scene.empty() && options.scene != entry.name) {
+            continue;
+        }
+        ++checked;
+        failed += !check(entry);
+    }
+    if (checked == 0) {
+        std::cerr << "ERROR::GOLDEN::UNKNOWN_SCENE: " << options.scene << std::endl;
+        return -1;
+    }
+    std::cout << checked - failed << "/" << checked << " scenes match" << std::endl;
+    return failed;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0] << " [--update] [--software] [--scene name] [--threshold t]"
+                  << " [--tolerance fraction] [--root dir] [--output-dir dir]" << std::endl;
+        return -1;
+    }
+
+    if (options.software) {
+        return check_scenes(demo::software_scenes(), options, [&options](const demo::SoftwareSceneEntry& entry) {
+            return check_software_scene(entry, options);
+        }) == 0 ? 0 : -1;
+    }
+
+    tools::HeadlessContext context(3, 3);
+    if (!context.valid()) {
+        return -1;
+    }
+    tools::RenderTarget target(width, height);
+    if (!target.valid()) {
+        return -1;
+    }
+    return check_scenes(demo::scenes(), options, [&options, &target](const demo::SceneEntry& entry) {
+        return check_scene(entry, options, target);
+    }) == 0 ? 0 : -1;
+}
@@ -0,0 +1,300 @@
+#include "tools/headless_context.h"
+#include "tools/shader.h"
+#include "tools/texture.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+/**
+ * Micro benchmarks for the tools library's hot paths, printed as json for scripts/compare_bench.py.
+ * usage: micro_bench [--filter text] [--repetitions n] [--min-time-ms ms] [--root dir] [--output file]
+ *
+ * every benchmark is calibrated until one repetition of n iterations takes --min-time-ms (which doubles as the
+ * warmup), then timed for --repetitions repetitions. the median per iteration is what gets compared between runs,
+ * it shrugs off the odd repetition that got preempted.
+ * the GL benchmarks run on a headless context and are skipped when there's none.
+ */
+
+namespace {
+
+struct Benchmark {
+    std::string name;
+    std::function<void()> run;
+    std::function<void()> finish; // once after every timed batch, inside the timing. e.g. glFinish for uploads
+    std::size_t bytes = 0; // per iteration, for a throughput figure
+};
+
+struct Result {
+    std::string name;
+    std::size_t iterations = 0;
+    std::size_t bytes = 0;
+    double mean_ns = 0.0;
+    double median_ns = 0.0;
+    double stddev_ns = 0.0;
+    double min_ns = 0.0;
+    double max_ns = 0.0;
+};
+
+struct Options {
+    std::string filter;
+    int repetitions = 10;
+    double min_time_ms = 20.0;
+    std::string root = TOOLS_BENCH_SOURCE_DIR;
+    std::string output;
+};
+
+double time_batch(const Benchmark& benchmark, std::size_t iterations) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        benchmark.run();
+    }
+    if (benchmark.finish) {
+        benchmark.finish();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+Result run_benchmark(const Benchmark& benchmark, const Options& options) {
+    const double min_time_ns = options.min_time_ms * 1e6;
+    std::size_t iterations = 1;
+    for (double elapsed = time_batch(benchmark, iterations); elapsed < min_time_ns;
+         elapsed = time_batch(benchmark, iterations)) {
+        // aim a bit past the target from what the last batch took, never more than 10x at once
+        const double scale = elapsed > 0.0 ? std::min(10.0, 1.2 * min_time_ns / elapsed) : 10.0;
+        iterations = std::max(iterations + 1, static_cast<std::size_t>(static_cast<double>(iterations) * scale));
+    }
+
+    std::vector<double> samples;
+    samples.reserve(options.repetitions);
+    for (int repetition = 0; repetition < options.repetitions; ++repetition) {
+        samples.push_back(time_batch(benchmark, iterations) / static_cast<double>(iterations));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.name = benchmark.name;
+    result.iterations = iterations;
+    result.bytes = benchmark.bytes;
+    const auto count = static_cast<double>(samples.size());
+    result.mean_ns = std::accumulate(samples.begin(), samples.end(), 0.0) / count;
+    result.median_ns = samples[samples.size() / 2];
+    double variance = 0.0;
+    for (double sample: samples) {
+        variance += (sample - result.mean_ns) * (sample - result.mean_ns);
+    }
+    result.stddev_ns = std::sqrt(variance / count);
+    result.min_ns = samples.front();
+    result.max_ns = samples.back();
+    return result;
+}
+
+/**
+ * keeps the compiler from dropping work whose result isn't used
+ */
+template<typename T>
+void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+void add_file_benchmarks(std::vector<Benchmark>& benchmarks, const std::string& root) {
+    for (const char* file: {"tools/apps/bench/uniforms.vert",
+                            "learn_opengl/excercises/04_textures/shaders/fragment_two_textures.frag"}) {
+        const std::string path = root + "/" + file;
+        benchmarks.push_back({"read_file/" + std::string(std::strrchr(file, '/') + 1), [path] {
+            do_not_optimize(tools::Shader::read_file(path));
+        }});
+    }
+
+    for (const char* file: {"wooden_container.jpg", "awesomeface.png", "tiles.png"}) {
+        const std::string path = root + "/learn_opengl/excercises/04_textures/resources/" + file;
+        // tried once up front, a file that doesn't decode would time an empty buffer
+        tools::Image probe;
+        if (!tools::load_image(path, probe)) {
+            std::cerr << "ERROR::MICRO_BENCH::CANNOT_LOAD_IMAGE: " << path << ", skipping it" << std::endl;
+            continue;
+        }
+        benchmarks.push_back({"load_image/" + std::string(file), [path] {
+            tools::Image image;
+            tools::load_image(path, image);
+            do_not_optimize(image.pixels.data());
+        }});
+    }
+}
+
+/**
+ * GL state the GL benchmarks share, alive for the whole run
+ */
+struct GlFixture {
+    std::unique_ptr<tools::Shader> shader;
+    unsigned int buffer = 0;
+    std::vector<unsigned char> data;
+
+    ~GlFixture() {
+        // without a context glad never loaded glDeleteBuffers
+        if (buffer != 0) {
+            glDeleteBuffers(1, &buffer);
+        }
+    }
+};
+
+void add_gl_benchmarks(std::vector<Benchmark>& benchmarks, GlFixture& fixture, const std::string& root) {
+    const std::string vertex = root + "/tools/apps/bench/uniforms.vert";
+    const std::string fragment = root + "/tools/apps/bench/uniforms.frag";
+    fixture.shader = std::make_unique<tools::Shader>(vertex, fragment);
+    fixture.shader->use();
+    tools::Shader& shader = *fixture.shader;
+
+    benchmarks.push_back({"shader_construction", [vertex, fragment] {
+        tools::Shader constructed(vertex, fragment);
+    }, glFinish});
+
+    benchmarks.push_back({"set_uniform_data/int", [&shader] {
+        shader.set_uniform_data<int>("count", 3);
+    }});
+    benchmarks.push_back({"set_uniform_data/float", [&shader] {
+        shader.set_uniform_data<float>("scale", 0.5f);
+    }});
+    benchmarks.push_back({"set_uniform_data/vec2", [&shader] {
+        shader.set_uniform_data<glm::vec2>("offset", glm::vec2(0.25f, 0.5f));
+    }});
+    benchmarks.push_back({"set_uniform_data/vec3", [&shader] {
+        shader.set_uniform_data<glm::vec3>("tint", glm::vec3(1.0f, 0.5f, 0.25f));
+    }});
+    benchmarks.push_back({"set_uniform_data/vec4", [&shader] {
+        shader.set_uniform_data<glm::vec4>("bias", glm::vec4(0.0f, 0.0f, 0.0f, 0.0f));
+    }});
+    benchmarks.push_back({"set_uniform_data/mat3", [&shader] {
+        shader.set_uniform_data<glm::mat3>("normal_matrix", glm::mat3(1.0f));
+    }});
+    benchmarks.push_back({"set_uniform_data/mat4", [&shader] {
+        shader.set_uniform_data<glm::mat4>("transform", glm::mat4(1.0f));
+    }});
+
+    // each upload finishes before the clock stops, so the driver's copy is in the number too
+    constexpr std::size_t largest = 16u << 20;
+    fixture.data.assign(largest, 0x5a);
+    glGenBuffers(1, &fixture.buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, fixture.buffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(largest), nullptr, GL_STREAM_DRAW);
+    for (std::size_t size: {std::size_t{4} << 10, std::size_t{64} << 10, std::size_t{1} << 20, largest}) {
+        const std::string label = size >= (1u << 20) ? std::to_string(size >> 20) + "MiB" : std::to_string(size >> 10) + "KiB";
+        const unsigned char* data = fixture.data.data();
+        const auto bytes = static_cast<GLsizeiptr>(size);
+        benchmarks.push_back({"buffer_data/" + label, [data, bytes] {
+            glBufferData(GL_ARRAY_BUFFER, bytes, data, GL_STREAM_DRAW);
+        }, glFinish, size});
+        benchmarks.push_back({"buffer_sub_data/" + label, [data, bytes] {
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, data);
+        }, glFinish, size});
+    }
+}
+
+std::string escape(const std::string& text) {
+    std::string escaped;
+    for (char c: text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void write_json(std::ostream& out, const Options& options, const std::string& renderer,
+                const std::vector<Result>& results) {
+    out << "{\n";
+    out << "  \"renderer\": \"" << escape(renderer) << "\",\n";
+    out << "  \"repetitions\": " << options.repetitions << ",\n";
+    out << "  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        out << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+            << ", \"mean_ns\": " << result.mean_ns << ", \"median_ns\": " << result.median_ns
+            << ", \"stddev_ns\": " << result.stddev_ns << ", \"min_ns\": " << result.min_ns
+            << ", \"max_ns\": " << result.max_ns;
+        if (result.bytes > 0) {
+            out << ", \"bytes\": " << result.bytes << ", \"mib_per_second\": "
+                << static_cast<double>(result.bytes) / (1 << 20) / (result.median_ns * 1e-9);
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && has_value) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && has_value) {
+            options.repetitions = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--min-time-ms") == 0 && has_value) {
+            options.min_time_ms = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--root") == 0 && has_value) {
+            options.root = argv[++i];
+        } else if (std::strcmp(argv[i], "--output") == 0 && has_value) {
+            options.output = argv[++i];
+        } else {
+            std::cerr << "unknown option: " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    return options.repetitions > 0 && options.min_time_ms > 0.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0]
+                  << " [--filter text] [--repetitions n] [--min-time-ms ms] [--root dir] [--output file]" << std::endl;
+        return -1;
+    }
+
+    std::vector<Benchmark> benchmarks;
+    add_file_benchmarks(benchmarks, options.root);
+
+    tools::HeadlessContext context(3, 3);
+    GlFixture fixture;
+    std::string renderer = "none";
+    if (context.valid()) {
+        renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+        add_gl_benchmarks(benchmarks, fixture, options.root);
+    } else {
+        std::cerr << "no GL context, skipping the GL benchmarks" << std::endl;
+    }
+
+    std::vector<Result> results;
+    for (const Benchmark& benchmark: benchmarks) {
+        if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        results.push_back(run_benchmark(benchmark, options));
+        std::cerr << results.back().name << ": " << results.back().median_ns << " ns" << std::endl;
+    }
+
+    if (options.output.empty()) {
+        write_json(std::cout, options, renderer, results);
+    } else {
+        std::ofstream file(options.output);
+        if (!file) {
+            std::cerr << "ERROR::MICRO_BENCH::CANNOT_WRITE: " << options.output << std::endl;
+            return -1;
+        }
+        write_json(file, options, renderer, results);
+    }
+    return 0;
+}
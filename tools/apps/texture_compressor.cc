@@ -0,0 +1,58 @@
+#include "tools/block_compression.h"
+#include "tools/texture.h"
+#include <cstring>
+#include <iostream>
+#include <string>
+
+/**
+ * Offline block compression, CPU only, no window or context needed.
+ * usage: texture_compressor <input image> <output.dds> [bc1|bc3|bc7] [--srgb] [--flip] [--no-mips]
+ */
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <input image> <output.dds> [bc1|bc3|bc7] [--srgb] [--flip] [--no-mips]"
+                  << std::endl;
+        return -1;
+    }
+
+    tools::BlockFormat format = tools::BlockFormat::bc1;
+    bool srgb = false;
+    bool flip = false;
+    bool mipmaps = true;
+    for (int i = 3; i < argc; ++i) {
+        if (std::strcmp(argv[i], "bc1") == 0) {
+            format = tools::BlockFormat::bc1;
+        } else if (std::strcmp(argv[i], "bc3") == 0) {
+            format = tools::BlockFormat::bc3;
+        } else if (std::strcmp(argv[i], "bc7") == 0) {
+            format = tools::BlockFormat::bc7;
+        } else if (std::strcmp(argv[i], "--srgb") == 0) {
+            srgb = true;
+        } else if (std::strcmp(argv[i], "--flip") == 0) {
+            flip = true;
+        } else if (std::strcmp(argv[i], "--no-mips") == 0) {
+            mipmaps = false;
+        } else {
+            std::cerr << "unknown option: " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
+    tools::Image image;
+    if (!tools::load_image(argv[1], image, flip, 4)) {
+        return -1;
+    }
+
+    const tools::CompressedImage compressed = tools::compress_image(image, format, srgb, mipmaps);
+    if (!tools::write_dds(argv[2], compressed)) {
+        return -1;
+    }
+
+    std::size_t total = 0;
+    for (const auto& level: compressed.levels) {
+        total += level.size();
+    }
+    std::cout << argv[1] << " -> " << argv[2] << ": " << image.width << "x" << image.height << ", "
+              << compressed.levels.size() << " levels, " << total << " bytes" << std::endl;
+    return 0;
+}
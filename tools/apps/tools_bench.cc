@@ -0,0 +1,256 @@
+#include "demo_scenes.hh"
+#include "tools/gl_stats.h"
+#include "tools/headless_context.h"
+#include "tools/render_target.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+/**
+ * Renders every demo scene offscreen for a fixed number of frames and prints the numbers as json.
+ * no window and no display needed, runs on Mesa llvmpipe in CI.
+ * usage: tools_bench [--frames n] [--warmup n] [--width w] [--height h] [--scene name] [--root dir] [--output file]
+ * the scenes are in demo_scenes.hh, --root is the source tree they read their shaders and textures from.
+ */
+
+namespace {
+
+constexpr int gpu_queries_in_flight = 4;
+
+struct Summary {
+    double mean = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+Summary summarize(std::vector<double> samples) {
+    Summary summary;
+    if (samples.empty()) {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+    summary.median = samples[samples.size() / 2];
+    summary.p95 = samples[std::min(samples.size() - 1, samples.size() * 95 / 100)];
+    summary.min = samples.front();
+    summary.max = samples.back();
+    return summary;
+}
+
+struct SceneResult {
+    std::string name;
+    bool ok = false;
+    double fps = 0.0;
+    Summary cpu_ms;
+    Summary gpu_ms;
+    double draw_calls = 0.0; // per frame
+    double state_changes = 0.0;
+    double uniform_updates = 0.0;
+};
+
+struct Options {
+    int frames = 500;
+    int warmup = 20;
+    int width = 800;
+    int height = 600;
+    std::string scene;
+    std::string root = TOOLS_BENCH_SOURCE_DIR;
+    std::string output;
+};
+
+SceneResult run_scene(const demo::SceneEntry& entry, const Options& options, tools::RenderTarget& target) {
+    SceneResult result;
+    result.name = entry.name;
+
+    std::unique_ptr<demo::Scene> scene = entry.create(options.root);
+    if (!scene->valid()) {
+        std::cerr << "ERROR::BENCH::SCENE_SETUP_FAILED: " << entry.name << std::endl;
+        return result;
+    }
+
+    target.bind();
+    for (int frame = 0; frame < options.warmup; ++frame) {
+        scene->render(frame);
+    }
+    glFinish();
+
+    // the timer results are read a few frames late, so waiting on them doesn't serialize cpu and gpu
+    unsigned int queries[gpu_queries_in_flight];
+    glGenQueries(gpu_queries_in_flight, queries);
+
+    std::vector<double> cpu_ms;
+    std::vector<double> gpu_ms;
+    cpu_ms.reserve(options.frames);
+    gpu_ms.reserve(options.frames);
+    auto read_query = [&](unsigned int query) {
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+        gpu_ms.push_back(static_cast<double>(nanoseconds) / 1e6);
+    };
+
+    tools::reset_gl_call_counts();
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < options.frames; ++frame) {
+        const unsigned int query = queries[frame % gpu_queries_in_flight];
+        if (frame >= gpu_queries_in_flight) {
+            read_query(query);
+        }
+
+        const auto frame_start = std::chrono::steady_clock::now();
+        glBeginQuery(GL_TIME_ELAPSED, query);
+        scene->render(options.warmup + frame);
+        glEndQuery(GL_TIME_ELAPSED);
+        // what a swap would do, hand the frame to the driver
+        glFlush();
+        const auto frame_end = std::chrono::steady_clock::now();
+        cpu_ms.push_back(std::chrono::duration<double, std::milli>(frame_end - frame_start).count());
+    }
+    for (int frame = std::max(0, options.frames - gpu_queries_in_flight); frame < options.frames; ++frame) {
+        read_query(queries[frame % gpu_queries_in_flight]);
+    }
+    glFinish();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    glDeleteQueries(gpu_queries_in_flight, queries);
+
+    const tools::GlCallCounts& counts = tools::gl_call_counts();
+    const auto frames = static_cast<double>(options.frames);
+    result.ok = true;
+    result.fps = seconds > 0.0 ? frames / seconds : 0.0;
+    result.cpu_ms = summarize(std::move(cpu_ms));
+    result.gpu_ms = summarize(std::move(gpu_ms));
+    result.draw_calls = static_cast<double>(counts.draw_calls) / frames;
+    result.state_changes = static_cast<double>(counts.state_changes) / frames;
+    result.uniform_updates = static_cast<double>(counts.uniform_updates) / frames;
+    return result;
+}
+
+std::string escape(const std::string& text) {
+    std::string escaped;
+    for (char c: text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void write_summary(std::ostream& out, const char* name, const Summary& summary) {
+    out << "      \"" << name << "\": {\"mean\": " << summary.mean << ", \"median\": " << summary.median
+        << ", \"p95\": " << summary.p95 << ", \"min\": " << summary.min << ", \"max\": " << summary.max << "}";
+}
+
+void write_json(std::ostream& out, const Options& options, const std::vector<SceneResult>& results) {
+    const auto* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    const auto* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+
+    out << "{\n";
+    out << "  \"renderer\": \"" << escape(renderer ? renderer : "") << "\",\n";
+    out << "  \"version\": \"" << escape(version ? version : "") << "\",\n";
+    out << "  \"width\": " << options.width << ",\n";
+    out << "  \"height\": " << options.height << ",\n";
+    out << "  \"frames\": " << options.frames << ",\n";
+    out << "  \"warmup\": " << options.warmup << ",\n";
+    out << "  \"scenes\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const SceneResult& result = results[i];
+        out << "    {\n";
+        out << "      \"name\": \"" << result.name << "\",\n";
+        out << "      \"ok\": " << (result.ok ? "true" : "false") << ",\n";
+        out << "      \"fps\": " << result.fps << ",\n";
+        write_summary(out, "cpu_ms", result.cpu_ms);
+        out << ",\n";
+        write_summary(out, "gpu_ms", result.gpu_ms);
+        out << ",\n";
+        out << "      \"draw_calls\": " << result.draw_calls << ",\n";
+        out << "      \"state_changes\": " << result.state_changes << ",\n";
+        out << "      \"uniform_updates\": " << result.uniform_updates << "\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--frames") == 0 && has_value) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--warmup") == 0 && has_value) {
+            options.warmup = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--width") == 0 && has_value) {
+            options.width = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--height") == 0 && has_value) {
+            options.height = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--scene") == 0 && has_value) {
+            options.scene = argv[++i];
+        } else if (std::strcmp(argv[i], "--root") == 0 && has_value) {
+            options.root = argv[++i];
+        } else if (std::strcmp(argv[i], "--output") == 0 && has_value) {
+            options.output = argv[++i];
+        } else {
+            std::cerr << "unknown option: " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    return options.frames > 0 && options.warmup >= 0 && options.width > 0 && options.height > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "usage: " << argv[0]
+                  << " [--frames n] [--warmup n] [--width w] [--height h] [--scene name] [--root dir] [--output file]"
+                  << std::endl;
+        return -1;
+    }
+
+    tools::HeadlessContext context(3, 3);
+    if (!context.valid()) {
+        return -1;
+    }
+    tools::enable_gl_call_counting();
+
+    tools::RenderTarget target(options.width, options.height);
+    if (!target.valid()) {
+        return -1;
+    }
+
+    std::vector<SceneResult> results;
+    bool failed = false;
+    for (const demo::SceneEntry& entry: demo::scenes()) {
+        if (!options.scene.empty() && options.scene != entry.name) {
+            continue;
+        }
+        results.push_back(run_scene(entry, options, target));
+        failed |= !results.back().ok;
+    }
+    if (results.empty()) {
+        std::cerr << "ERROR::BENCH::UNKNOWN_SCENE: " << options.scene << std::endl;
+        return -1;
+    }
+
+    if (options.output.empty()) {
+        write_json(std::cout, options, results);
+    } else {
+        std::ofstream file(options.output);
+        if (!file) {
+            std::cerr << "ERROR::BENCH::CANNOT_WRITE: " << options.output << std::endl;
+            return -1;
+        }
+        write_json(file, options, results);
+    }
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,123 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_ATLAS_H
+#define OPENGL_GEMINI_GUIDANCE_ATLAS_H
+
+#include "glad/glad.h"
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+namespace tools {
+
+struct AtlasRect {
+    int x;
+    int y;
+    int width;
+    int height;
+};
+
+struct AtlasRegion {
+    AtlasRect rect; // pixels of the image itself, padding not included
+    glm::vec2 uv_min;
+    glm::vec2 uv_max;
+};
+
+/**
+ * Skyline bottom-left packer.
+ * keeps the top edge of everything packed so far as a list of horizontal segments,
+ * and places every new rect at the lowest spot it fits.
+ */
+class SkylinePacker {
+public:
+    SkylinePacker(int width, int height);
+
+    /**
+     * @param width width of the rect to place
+     * @param height height of the rect to place
+     * @param out the placed rect, only valid when returning true
+     * @return false when the rect doesn't fit anymore
+     */
+    bool pack(int width, int height, AtlasRect& out);
+
+    void reset();
+
+private:
+    struct Segment {
+        int x;
+        int y;
+        int width;
+    };
+
+    int fit(std::size_t index, int width, int height) const;
+
+    void add_segment(std::size_t index, const AtlasRect& rect);
+
+    int _width;
+    int _height;
+    std::vector<Segment> _skyline;
+};
+
+/**
+ * Packs many small RGBA images into one big texture, so a whole UI can be drawn with one bind.
+ * every image gets `padding` pixels around it, filled by extruding the image's edges,
+ * so linear filtering and the first few mip levels don't bleed the neighbours in.
+ */
+class TextureAtlas {
+public:
+    TextureAtlas(int width, int height, int padding = 4);
+
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&) = delete;
+
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    /**
+     * @return region id, or -1 if the image couldn't be loaded or there's no room left
+     */
+    int add_image(const std::string& path);
+
+    int add_image(const unsigned char* rgba, int width, int height);
+
+    /**
+     * Offline-style build: packs the tallest images first, which wastes a lot less space than
+     * packing in whatever order they come.
+     * @return region ids in the same order as `paths`
+     */
+    std::vector<int> add_images(const std::vector<std::string>& paths);
+
+    const AtlasRegion& region(int id) const;
+
+    std::size_t size() const;
+
+    int width() const;
+
+    int height() const;
+
+    /**
+     * the CPU side RGBA8 pixels, for dumping the atlas to disk or feeding an encoder.
+     */
+    const std::vector<unsigned char>& pixels() const;
+
+    /**
+     * Creates (or refreshes) the GL texture. mip levels are capped by the padding.
+     * @return the texture id
+     */
+    unsigned int upload();
+
+    unsigned int texture() const;
+
+private:
+    void blit_extruded(const unsigned char* rgba, int width, int height, const AtlasRect& padded);
+
+    int _width;
+    int _height;
+    int _padding;
+    SkylinePacker _packer;
+    std::vector<unsigned char> _pixels;
+    std::vector<AtlasRegion> _regions;
+    unsigned int _texture = 0;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_ATLAS_H
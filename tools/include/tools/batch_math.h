@@ -0,0 +1,45 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_BATCH_MATH_H
+#define OPENGL_GEMINI_GUIDANCE_BATCH_MATH_H
+
+#include "tools/scene_graph.h"
+#include <glm/glm.hpp>
+#include <span>
+
+namespace tools {
+
+/**
+ * Transform stage kernels over whole arrays. AVX2 when the CPU has it, plain glm otherwise.
+ * the AVX2 paths do the same multiplies and adds in the same order as glm's scalar code (no FMA),
+ * so the results are bitwise identical to looping over glm, just several times faster.
+ * `out` may be the same array as the input, and has to be at least as long.
+ */
+
+/**
+ * out[i] = left * right[i], e.g. projection * view times every model matrix
+ */
+void multiply(const glm::mat4& left, std::span<const glm::mat4> right, std::span<glm::mat4> out);
+
+/**
+ * out[i] = to_matrix(transforms[i]), 8 at a time
+ */
+void compose(std::span<const Transform> transforms, std::span<glm::mat4> out);
+
+/**
+ * out[i] = (matrix * vec4(points[i], 1)).xyz, no perspective divide
+ */
+void transform_points(const glm::mat4& matrix, std::span<const glm::vec3> points, std::span<glm::vec3> out);
+
+/**
+ * false makes the kernels take the glm loops on AVX2 CPUs too, so both paths can be checked in one run
+ * (tools/apps/batch_math_check). true by default
+ */
+void set_batch_math_avx2(bool enabled);
+
+/**
+ * whether the kernels currently take the AVX2 path: the CPU has it and it isn't switched off
+ */
+bool batch_math_avx2();
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_BATCH_MATH_H
@@ -0,0 +1,83 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_BLOCK_COMPRESSION_H
+#define OPENGL_GEMINI_GUIDANCE_BLOCK_COMPRESSION_H
+
+#include "glad/glad.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// S3TC is an extension, and our glad is generated without any
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+namespace tools {
+
+struct Image;
+
+/**
+ * All of these work on 4x4 pixel blocks.
+ * bc1: 8 bytes per block, RGB only (4 bits per pixel)
+ * bc3: 16 bytes per block, bc1 colour + 8 level alpha (8 bits per pixel)
+ * bc7: 16 bytes per block, RGBA with much better quality. we only encode mode 6
+ */
+enum class BlockFormat {
+    bc1,
+    bc3,
+    bc7
+};
+
+struct CompressedImage {
+    BlockFormat format = BlockFormat::bc1;
+    bool srgb = false;
+    int width = 0;
+    int height = 0;
+    std::vector<std::vector<std::uint8_t>> levels; // level 0 first
+    int level_count = 0; // the whole chain in the file, load_dds with a first_level leaves out some of levels
+};
+
+int block_bytes(BlockFormat format);
+
+GLenum compressed_internal_format(BlockFormat format, bool srgb);
+
+/**
+ * needs a current context. bc7 is core since 4.2, bc1/bc3 need GL_EXT_texture_compression_s3tc
+ */
+bool compressed_format_supported(BlockFormat format);
+
+/**
+ * @param rgba 16 pixels, row by row
+ * @param out 8 bytes
+ */
+void encode_bc1_block(const std::uint8_t* rgba, std::uint8_t* out);
+
+/**
+ * @param out 16 bytes
+ */
+void encode_bc3_block(const std::uint8_t* rgba, std::uint8_t* out);
+
+/**
+ * @param out 16 bytes
+ */
+void encode_bc7_block(const std::uint8_t* rgba, std::uint8_t* out);
+
+/**
+ * Compresses a 4 channel image and (optionally) its whole box filtered mip chain. CPU only.
+ * sizes that aren't a multiple of 4 are fine, the edge pixels get repeated into the last block.
+ */
+CompressedImage compress_image(const Image& rgba, BlockFormat format, bool srgb, bool mipmaps = true);
+
+bool write_dds(const std::string& path, const CompressedImage& image);
+
+/**
+ * @param first_level levels above this one are skipped without being read, `out.levels[0]` is then
+ * `first_level` while width/height stay the full size
+ */
+bool load_dds(const std::string& path, CompressedImage& out, int first_level = 0);
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_BLOCK_COMPRESSION_H
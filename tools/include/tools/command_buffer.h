@@ -0,0 +1,40 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_COMMAND_BUFFER_H
+#define OPENGL_GEMINI_GUIDANCE_COMMAND_BUFFER_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace tools {
+
+/**
+ * A list of GL work recorded on one thread and executed later, in order, on the thread owning the context.
+ * commands run after record() returns, so capture by value whatever can change in the meantime
+ * (uniform values, matrices...). objects captured by reference have to outlive the execution.
+ */
+class CommandBuffer {
+public:
+    template<typename Command>
+    void record(Command&& command) {
+        _commands.emplace_back(std::forward<Command>(command));
+    }
+
+    void execute() const;
+
+    /**
+     * keeps the storage, so recording the next frame doesn't allocate the list again
+     */
+    void clear();
+
+    std::size_t size() const;
+
+    bool empty() const;
+
+private:
+    std::vector<std::function<void()>> _commands;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_COMMAND_BUFFER_H
@@ -0,0 +1,94 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_CULLING_H
+#define OPENGL_GEMINI_GUIDANCE_CULLING_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tools {
+
+// dot(normal, p) + distance >= 0 is inside, normal is unit length
+struct Plane {
+    glm::vec3 normal;
+    float distance;
+};
+
+struct Frustum {
+    Plane planes[6]; // left, right, bottom, top, near, far
+};
+
+/**
+ * the six planes of `projection * view` (Gribb & Hartmann). with a model matrix in there too,
+ * the planes come out in that model's space instead of world space.
+ */
+Frustum extract_frustum(const glm::mat4& view_projection);
+
+/**
+ * Bounding spheres as structure of arrays, so eight of them load into one AVX2 register per component.
+ * the arrays are padded to a multiple of 8 with spheres that are never visible, so the cull loop has no tail.
+ */
+class BoundingSpheres {
+public:
+    /**
+     * @return the index culling reports for this sphere
+     */
+    std::uint32_t add(const glm::vec3& centre, float radius);
+
+    void set(std::uint32_t index, const glm::vec3& centre, float radius);
+
+    void clear();
+
+    std::size_t size() const;
+
+    const float* x() const;
+
+    const float* y() const;
+
+    const float* z() const;
+
+    const float* radius() const;
+
+private:
+    std::size_t _size = 0;
+    std::vector<float> _x, _y, _z, _radius;
+};
+
+/**
+ * Axis aligned boxes as centre + half extents, structure of arrays and padded like BoundingSpheres.
+ */
+class BoundingBoxes {
+public:
+    std::uint32_t add(const glm::vec3& min, const glm::vec3& max);
+
+    void set(std::uint32_t index, const glm::vec3& min, const glm::vec3& max);
+
+    void clear();
+
+    std::size_t size() const;
+
+    const float* centre(int axis) const;
+
+    const float* extent(int axis) const;
+
+private:
+    std::size_t _size = 0;
+    std::vector<float> _centre[3];
+    std::vector<float> _extent[3];
+};
+
+/**
+ * writes the indices of everything at least partly inside the frustum to `visible`, in index order.
+ * 8 per iteration with AVX2 when the CPU has it (checked once at runtime), scalar otherwise.
+ * @param thread_count > 1 splits the array into that many chunks, culled as JobSystem::shared() jobs
+ * @return the visible count, also visible.size()
+ */
+std::size_t cull(const Frustum& frustum, const BoundingSpheres& spheres, std::vector<std::uint32_t>& visible,
+                 unsigned int thread_count = 1);
+
+std::size_t cull(const Frustum& frustum, const BoundingBoxes& boxes, std::vector<std::uint32_t>& visible,
+                 unsigned int thread_count = 1);
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_CULLING_H
@@ -0,0 +1,97 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_DRAW_QUEUE_H
+#define OPENGL_GEMINI_GUIDANCE_DRAW_QUEUE_H
+
+#include "glad/glad.h"
+#include "tools/geometry_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tools {
+
+// the layout glMultiDrawElementsIndirect reads from the indirect buffer
+struct DrawElementsIndirectCommand {
+    std::uint32_t count;
+    std::uint32_t instance_count;
+    std::uint32_t first_index;
+    std::int32_t base_vertex;
+    std::uint32_t base_instance;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand must match the GL layout");
+
+/**
+ * Collects the frame's draws and submits them with one glMultiDrawElementsIndirect per GeometryPool.
+ * every draw brings its own per instance data (a model matrix, a material index...), it all goes into
+ * one storage buffer and the command's base_instance points at the draw's first record.
+ * the shader finds its record through an instanced `draw_id` attribute (0, 1, 2... with divisor 1,
+ * offset by base_instance), which works on 4.3 without ARB_shader_draw_parameters:
+ *     layout(location = 15) in uint draw_id;
+ *     struct Draw { mat4 model; };
+ *     layout(std430, binding = 0) readonly buffer Draws { Draw draws[]; };
+ *     ... draws[draw_id].model ...
+ * std430 rounds the struct up to its biggest member alignment, keep `record_size` in step with that.
+ * needs a 4.3 context, see Window.
+ */
+class DrawQueue {
+public:
+    /**
+     * @param record_size bytes of per instance data
+     * @param storage_binding the std430 buffer binding the records are bound to
+     * @param draw_id_location attribute location of `draw_id`, must be free in every pool's layout
+     */
+    explicit DrawQueue(std::size_t record_size, GLuint storage_binding = 0, GLuint draw_id_location = 15);
+
+    ~DrawQueue();
+
+    DrawQueue(const DrawQueue&) = delete;
+
+    DrawQueue& operator=(const DrawQueue&) = delete;
+
+    /**
+     * @param records `instance_count` records of `record_size` bytes, copied right away
+     */
+    void submit(const GeometryPool& pool, int handle, const void* records, std::uint32_t instance_count = 1);
+
+    /**
+     * uploads the commands and records and draws everything, grouped by pool in submission order.
+     * the shader has to be in use already. the queue is empty afterwards.
+     * @return the number of GL draw calls it took
+     */
+    int flush();
+
+    void clear();
+
+    std::size_t draw_count() const;
+
+    bool supported() const;
+
+private:
+    struct Pending {
+        const GeometryPool* pool;
+        DrawElementsIndirectCommand command;
+    };
+
+    void upload(unsigned int buffer, GLenum target, std::size_t& capacity, const void* data, std::size_t bytes);
+
+    std::size_t _record_size;
+    GLuint _storage_binding;
+    GLuint _draw_id_location;
+    bool _supported = false;
+
+    std::vector<Pending> _pending;
+    std::vector<DrawElementsIndirectCommand> _commands;
+    std::vector<std::uint8_t> _records;
+    std::uint32_t _record_count = 0;
+
+    unsigned int _indirect_buffer = 0;
+    unsigned int _storage_buffer = 0;
+    unsigned int _draw_id_buffer = 0;
+    std::size_t _indirect_capacity = 0;
+    std::size_t _storage_capacity = 0;
+    std::size_t _draw_id_capacity = 0; // in ids
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_DRAW_QUEUE_H
@@ -0,0 +1,76 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_FRAME_CAPTURE_H
+#define OPENGL_GEMINI_GUIDANCE_FRAME_CAPTURE_H
+
+#include "glad/glad.h"
+#include "tools/texture.h"
+#include <cstddef>
+#include <vector>
+
+namespace tools {
+
+/**
+ * Reads frames back through a ring of pixel pack buffers.
+ * request() only queues the copy (glReadPixels into a PBO + a fence), so the CPU keeps going while the GPU
+ * finishes the frame. poll() hands frames back once their fence has signalled, wait() blocks for the oldest.
+ * frames come back as RGBA8 images, top row first, ready for encode_png.
+ */
+class FrameCapture {
+public:
+    /**
+     * @param ring_size how many reads may be in flight, 2-3 frames is usually enough to never wait
+     */
+    FrameCapture(int width, int height, int ring_size = 3);
+
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    /**
+     * queues a read of colour attachment 0 of `framebuffer` (0 is the window).
+     * leaves `framebuffer` bound for reading.
+     * @return false when every slot is still waiting to be collected
+     */
+    bool request(unsigned int framebuffer = 0);
+
+    /**
+     * the oldest queued frame if the GPU is done with it, without waiting
+     */
+    bool poll(Image& out);
+
+    /**
+     * the oldest queued frame, waiting for the GPU if it has to
+     * @return false if nothing is queued
+     */
+    bool wait(Image& out);
+
+    std::size_t pending() const;
+
+    int width() const;
+
+    int height() const;
+
+private:
+    struct Slot {
+        unsigned int buffer = 0;
+        GLsync fence = nullptr;
+    };
+
+    void collect(Slot& slot, Image& out);
+
+    int _width;
+    int _height;
+    std::vector<Slot> _slots;
+    std::size_t _oldest = 0;
+    std::size_t _pending = 0;
+};
+
+/**
+ * one synchronous read of `framebuffer`, for tests and one-off screenshots
+ */
+Image capture_framebuffer(unsigned int framebuffer, int width, int height);
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_FRAME_CAPTURE_H
@@ -0,0 +1,111 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_FRAME_EXPORTER_H
+#define OPENGL_GEMINI_GUIDANCE_FRAME_EXPORTER_H
+
+#include "tools/job_system.h"
+#include "tools/texture.h"
+#include <cstddef>
+#include <cstdint>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tools {
+
+enum class ExportFormat {
+    png,
+    raw // the RGBA8 pixels as they are, top row first
+};
+
+struct ExportDesc {
+    ExportFormat format = ExportFormat::png;
+    /**
+     * image sequence: <directory>/<prefix>000000.png, ... (.rgba for raw). the directory has to exist
+     */
+    std::string directory = ".";
+    std::string prefix = "frame_";
+    /**
+     * when set, frames go in order to this command's stdin instead of to files. e.g. for raw 1280x720:
+     * ffmpeg -y -f rawvideo -pix_fmt rgba -s 1280x720 -r 60 -i - -c:v libx264 -pix_fmt yuv420p out.mp4
+     * or with png: ffmpeg -y -f image2pipe -c:v png -r 60 -i - out.mp4
+     * if the command exits early, writing to it raises SIGPIPE, ignore that signal to get ok() == false instead
+     */
+    std::string pipe_command;
+    std::size_t max_queued_frames = 8; // submit() waits when this many aren't written yet, so memory stays bounded
+};
+
+/**
+ * Encodes and writes frames as JobSystem jobs.
+ * frames are encoded in parallel, a pipe still gets them in submission order: an encoded frame waits in a map until
+ * the ones before it are written, and the job that finishes the next frame in line writes it and whatever is ready
+ * after it. no job ever blocks on another one's turn.
+ */
+class FrameExporter {
+public:
+    explicit FrameExporter(const ExportDesc& desc, JobSystem& jobs = JobSystem::shared());
+
+    /**
+     * finishes writing everything submitted
+     */
+    ~FrameExporter();
+
+    FrameExporter(const FrameExporter&) = delete;
+
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    /**
+     * queues a frame. when max_queued_frames aren't written yet it helps run jobs until one of them is
+     */
+    void submit(Image frame);
+
+    /**
+     * waits for every submitted frame to be written, then closes the pipe. no submit() after this
+     */
+    void finish();
+
+    /**
+     * false once anything failed to open or write
+     */
+    bool ok() const;
+
+    std::uint64_t frames_written() const;
+
+private:
+    void encode(std::uint64_t index, Image frame);
+
+    void write_file(std::uint64_t index, const std::vector<std::uint8_t>& bytes);
+
+    /**
+     * queues the frame for the pipe, and writes it and the ones after it if it is next in line
+     */
+    void write_pipe(std::uint64_t index, std::vector<std::uint8_t> bytes);
+
+    /**
+     * one frame less in flight
+     */
+    void done(bool written);
+
+    ExportDesc _desc;
+    JobSystem& _job_system;
+    JobGroup _encodes;
+    std::FILE* _pipe = nullptr;
+    std::uint64_t _next_index = 0; // submit() side only
+    bool _finished = false;
+
+    mutable std::mutex _mutex;
+    std::size_t _in_flight = 0; // submitted, not written yet
+    std::condition_variable _slot_freed; // _in_flight went down
+    std::uint64_t _written = 0;
+    bool _failed = false;
+
+    std::mutex _pipe_mutex;
+    std::map<std::uint64_t, std::vector<std::uint8_t>> _encoded; // waiting for the frames before them
+    std::uint64_t _next_to_write = 0;
+    bool _writing = false; // a job is writing, everything else just drops its frame in _encoded
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_FRAME_EXPORTER_H
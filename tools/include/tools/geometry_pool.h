@@ -0,0 +1,145 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_GEOMETRY_POOL_H
+#define OPENGL_GEMINI_GUIDANCE_GEOMETRY_POOL_H
+
+#include "glad/glad.h"
+#include "tools/mesh.h"
+#include "tools/vertex_layout.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace tools {
+
+/**
+ * Best fit allocator over a range of elements, free neighbours are merged back together.
+ * doesn't touch any memory itself, it only hands out offsets.
+ */
+class RangeAllocator {
+public:
+    explicit RangeAllocator(std::size_t capacity);
+
+    bool allocate(std::size_t size, std::size_t& offset);
+
+    void free(std::size_t offset, std::size_t size);
+
+    /**
+     * adds the range [capacity, new_capacity) as free space
+     */
+    void grow(std::size_t new_capacity);
+
+    std::size_t capacity() const;
+
+    std::size_t used() const;
+
+private:
+    void insert_free(std::size_t offset, std::size_t size);
+
+    void erase_free(std::map<std::size_t, std::size_t>::iterator block);
+
+    std::size_t _capacity;
+    std::size_t _used = 0;
+    std::map<std::size_t, std::size_t> _by_offset;    // offset -> size
+    std::multimap<std::size_t, std::size_t> _by_size; // size -> offset
+};
+
+struct MeshAllocation {
+    std::uint32_t base_vertex;
+    std::uint32_t vertex_count;
+    std::uint32_t first_index;
+    std::uint32_t index_count;
+};
+
+/**
+ * Many meshes in one vertex buffer and one index buffer, behind a single VAO.
+ * indices stay relative to their own mesh and glDrawElementsBaseVertex adds the offset,
+ * so drawing another mesh of the same format never switches VAO or buffers.
+ * one pool per vertex format. the buffers grow (by copying on the GPU) when they run out.
+ */
+class GeometryPool {
+public:
+    /**
+     * @param index_type GL_UNSIGNED_SHORT works for any mesh under 65536 vertices, thanks to the base vertex
+     */
+    GeometryPool(const VertexLayout& layout, std::size_t vertex_capacity, std::size_t index_capacity,
+                 GLenum index_type = GL_UNSIGNED_INT);
+
+    ~GeometryPool();
+
+    GeometryPool(const GeometryPool&) = delete;
+
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    /**
+     * @param vertices `vertex_count` vertices laid out as the pool's layout
+     * @return handle, or -1 if a 16 bit pool can't index that many vertices or an index is past them
+     */
+    int add(const void* vertices, std::size_t vertex_count, const std::uint32_t* indices, std::size_t index_count);
+
+    /**
+     * quantizes to CompactVertex first if the pool has the compact layout
+     */
+    int add(const Mesh& mesh);
+
+    /**
+     * another index list over the vertices of `handle`, a LOD level for example.
+     * the new handle only owns its indices, remove it before the mesh it borrows from.
+     * @return handle, or -1 if `handle` isn't a live mesh or an index is past its vertices
+     */
+    int add_indices(int handle, const std::uint32_t* indices, std::size_t index_count);
+
+    void remove(int handle);
+
+    /**
+     * true if add() or add_indices() returned it and it wasn't removed since
+     */
+    bool valid(int handle) const;
+
+    /**
+     * expects a valid handle
+     */
+    const MeshAllocation& allocation(int handle) const;
+
+    void bind() const;
+
+    /**
+     * expects bind() to have been called
+     */
+    void draw(int handle, GLsizei instance_count = 1) const;
+
+    const VertexLayout& layout() const;
+
+    GLenum index_type() const;
+
+    std::size_t index_size() const;
+
+    unsigned int vertex_buffer() const;
+
+    unsigned int index_buffer() const;
+
+private:
+    void ensure_capacity(std::size_t vertex_count, std::size_t index_count);
+
+    static bool indices_in_range(const std::uint32_t* indices, std::size_t index_count, std::size_t vertex_count);
+
+    std::size_t upload_indices(const std::uint32_t* indices, std::size_t index_count);
+
+    int make_handle(const MeshAllocation& allocation, bool owns_vertices);
+
+    static void grow_buffer(unsigned int& buffer, std::size_t old_bytes, std::size_t new_bytes);
+
+    VertexLayout _layout;
+    GLenum _index_type;
+    unsigned int _vao = 0;
+    unsigned int _vbo = 0;
+    unsigned int _ebo = 0;
+    RangeAllocator _vertices;
+    RangeAllocator _indices;
+    std::vector<MeshAllocation> _allocations;
+    std::vector<bool> _live;
+    std::vector<bool> _owns_vertices;
+    std::vector<int> _free_handles;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_GEOMETRY_POOL_H
@@ -0,0 +1,28 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_GL_STATS_H
+#define OPENGL_GEMINI_GUIDANCE_GL_STATS_H
+
+#include <cstdint>
+
+namespace tools {
+
+struct GlCallCounts {
+    std::uint64_t draw_calls = 0; // every glDraw* / glMultiDraw* call, a multi draw counts once
+    std::uint64_t state_changes = 0; // program, vertex array, buffer, texture, sampler, framebuffer binds and fixed function state
+    std::uint64_t uniform_updates = 0; // glUniform*
+};
+
+/**
+ * Wraps glad's function pointers for draws, binds and uniforms with counting ones, so everything going
+ * through glad is counted, the tools classes included. redundant calls are counted too, they cost the driver
+ * all the same. call it after glad is loaded, loading glad again puts the plain pointers back.
+ * counting isn't thread safe, same as the GL context it counts.
+ */
+void enable_gl_call_counting();
+
+const GlCallCounts& gl_call_counts();
+
+void reset_gl_call_counts();
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_GL_STATS_H
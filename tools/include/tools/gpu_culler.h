@@ -0,0 +1,92 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_GPU_CULLER_H
+#define OPENGL_GEMINI_GUIDANCE_GPU_CULLER_H
+
+#include "glad/glad.h"
+#include "tools/culling.h"
+#include "tools/geometry_pool.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+
+namespace tools {
+
+// one object on the GPU, std430 layout
+struct GpuInstance {
+    glm::vec4 sphere;      // xyz centre, w radius
+    std::int32_t mesh;     // GeometryPool handle
+    std::uint32_t record;  // what the vertex shader gets as draw_id, e.g. the index of its model matrix
+    std::uint32_t padding[2];
+};
+
+static_assert(sizeof(GpuInstance) == 32, "GpuInstance must match the std430 struct");
+
+/**
+ * Frustum culling in a compute shader, straight into indirect draw commands.
+ *
+ * there is one DrawElementsIndirectCommand per mesh, and every mesh owns a slice of the visible list big
+ * enough for all its instances (base_instance points at it). the shader tests each instance's sphere and,
+ * if it passes, bumps its mesh's instance_count atomically and writes its record into the free slot.
+ * draw() then feeds the commands to glMultiDrawElementsIndirect, the CPU never sees the result.
+ * the visible list is bound as the same instanced `draw_id` attribute DrawQueue uses, so one vertex
+ * shader serves both paths.
+ * needs a 4.3 context.
+ */
+class GpuCuller {
+public:
+    explicit GpuCuller(GLuint draw_id_location = 15);
+
+    ~GpuCuller();
+
+    GpuCuller(const GpuCuller&) = delete;
+
+    GpuCuller& operator=(const GpuCuller&) = delete;
+
+    /**
+     * uploads the instances and builds the command templates. only needed again when the set changes,
+     * moving things around can rewrite the spheres in instance_buffer() directly
+     * (`mesh` in there has become the command index, leave it alone).
+     * @return false if an instance's mesh isn't a valid handle of the pool, the old instances stay then
+     */
+    bool set_instances(const GeometryPool& pool, std::span<const GpuInstance> instances);
+
+    /**
+     * resets the commands and dispatches the cull. leaves the culling program in use and storage
+     * buffer bindings 0-2 changed, so bind the draw shader and its buffers afterwards.
+     */
+    void cull(const Frustum& frustum);
+
+    /**
+     * @return the number of GL draw calls it took, 1 or 0
+     */
+    int draw() const;
+
+    /**
+     * reads the atomic counter back, stalls until the cull has run. for stats and debugging only.
+     */
+    std::uint32_t read_visible_count() const;
+
+    unsigned int instance_buffer() const;
+
+    bool supported() const;
+
+private:
+    GLuint _draw_id_location;
+    bool _supported = false;
+    const GeometryPool* _pool = nullptr;
+    std::uint32_t _instance_count = 0;
+    GLsizei _command_count = 0;
+
+    unsigned int _program = 0;
+    int _planes_location = -1;
+    int _instance_count_location = -1;
+
+    unsigned int _instance_buffer = 0;
+    unsigned int _template_buffer = 0; // the commands with instance_count 0, copied over every cull
+    unsigned int _command_buffer = 0;
+    unsigned int _visible_buffer = 0;
+    unsigned int _counter_buffer = 0;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_GPU_CULLER_H
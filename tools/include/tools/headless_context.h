@@ -0,0 +1,33 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_HEADLESS_CONTEXT_H
+#define OPENGL_GEMINI_GUIDANCE_HEADLESS_CONTEXT_H
+
+namespace tools {
+
+/**
+ * A core GL context with no window and no display server, through EGL's surfaceless platform
+ * (Mesa, llvmpipe included) or any EGL that has EGL_KHR_surfaceless_context.
+ * there's no default framebuffer, render into a RenderTarget. loads glad on success.
+ */
+class HeadlessContext {
+public:
+    HeadlessContext(int gl_major = 3, int gl_minor = 3);
+
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    bool valid() const;
+
+    void make_current();
+
+private:
+    // EGLDisplay and EGLContext, kept opaque so eglplatform.h (and X11 with it) stays out of the header
+    void* _display = nullptr;
+    void* _context = nullptr;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_HEADLESS_CONTEXT_H
@@ -0,0 +1,29 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_IMAGE_COMPARE_H
+#define OPENGL_GEMINI_GUIDANCE_IMAGE_COMPARE_H
+
+#include "tools/texture.h"
+#include <cstddef>
+
+namespace tools {
+
+struct ImageDifference {
+    bool same_size = false;
+    std::size_t differing_pixels = 0; // over the threshold
+    double differing_fraction = 0.0;
+    double max_delta = 0.0; // 0 identical, 1 black vs white
+    double mean_delta = 0.0;
+};
+
+/**
+ * Perceptual per pixel comparison of two 3 or 4 channel images, in YIQ space (Kotsarenko & Ramos),
+ * the same metric pixelmatch uses. luma counts about twice as much as chroma, like it does to the eye,
+ * so a driver rounding a colour differently by a step or two stays well under the threshold while a
+ * missing or misplaced triangle doesn't. alpha is blended against white first.
+ * @param threshold per pixel delta (0-1) over which a pixel counts as different, 0.1 is pixelmatch's default
+ * @param diff if not null, gets a visualization: faded greyscale of `a` with differing pixels in red
+ */
+ImageDifference compare_images(const Image& a, const Image& b, double threshold = 0.1, Image* diff = nullptr);
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_IMAGE_COMPARE_H
@@ -0,0 +1,246 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_INPUT_H
+#define OPENGL_GEMINI_GUIDANCE_INPUT_H
+
+#include "tools/spsc_ring.h"
+#include <GLFW/glfw3.h>
+#include <atomic>
+#include <bitset>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tools {
+
+class InputRecorder;
+
+class InputReplay;
+
+enum class InputEventType : std::uint8_t {
+    key,
+    mouse_button,
+    cursor, // x, y: position in screen coordinates
+    scroll, // x, y: offsets
+    resize // x, y: framebuffer width and height
+};
+
+/**
+ * one glfw callback, plain data so a frame's worth can be copied around and written out as is
+ */
+struct InputEvent {
+    InputEventType type;
+    std::uint8_t action; // GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+    std::uint16_t mods;
+    std::int32_t code; // the key or mouse button
+    double x;
+    double y;
+};
+
+/**
+ * what input looked like at the start of the frame. pressed / released are the changes since the frame before,
+ * a key tapped between two frames is pressed and released in the same snapshot.
+ */
+class InputState {
+public:
+    bool key_down(int key) const;
+
+    bool key_pressed(int key) const;
+
+    bool key_released(int key) const;
+
+    bool button_down(int button) const;
+
+    bool button_pressed(int button) const;
+
+    bool button_released(int button) const;
+
+    double cursor_x() const;
+
+    double cursor_y() const;
+
+    /**
+     * cursor movement since the last frame
+     */
+    double cursor_dx() const;
+
+    double cursor_dy() const;
+
+    double scroll_x() const;
+
+    double scroll_y() const;
+
+    /**
+     * the latest resize, 0 until there was one
+     */
+    int framebuffer_width() const;
+
+    int framebuffer_height() const;
+
+    /**
+     * events that take an empty snapshot to this one's held keys and buttons, cursor and framebuffer size
+     */
+    std::vector<InputEvent> as_events() const;
+
+private:
+    friend class Input;
+
+    void begin_frame();
+
+    void apply(const InputEvent& event);
+
+    std::bitset<GLFW_KEY_LAST + 1> _keys_down;
+    std::bitset<GLFW_KEY_LAST + 1> _keys_pressed;
+    std::bitset<GLFW_KEY_LAST + 1> _keys_released;
+    std::bitset<GLFW_MOUSE_BUTTON_LAST + 1> _buttons_down;
+    std::bitset<GLFW_MOUSE_BUTTON_LAST + 1> _buttons_pressed;
+    std::bitset<GLFW_MOUSE_BUTTON_LAST + 1> _buttons_released;
+    double _cursor_x = 0.0;
+    double _cursor_y = 0.0;
+    double _cursor_dx = 0.0;
+    double _cursor_dy = 0.0;
+    bool _has_cursor = false; // the first position isn't a movement
+    double _scroll_x = 0.0;
+    double _scroll_y = 0.0;
+    int _framebuffer_width = 0;
+    int _framebuffer_height = 0;
+};
+
+/**
+ * Event queue between the glfw callbacks and the frame loop.
+ * callbacks push into a lock-free single producer / single consumer ring, so the frame loop can run on another
+ * thread than the one polling events. once per frame update() drains it: the events go into the snapshot and to
+ * the listeners, in the order they happened.
+ *
+ * update() is also the frame clock. time() and delta_time() come from glfwGetTime, or a fixed step, and a session
+ * can be recorded to a file (every frame's step and events) and replayed from it: while replaying the window's
+ * own events are thrown away and every frame gets the recorded step and events, however long it actually took.
+ * so a demo animated off time() and driven by state() does the same thing frame for frame on every run,
+ * and the frame times of two runs can be compared.
+ */
+class Input {
+public:
+    static constexpr std::size_t capacity = 1024;
+
+    using Listener = std::function<void(const InputEvent&)>;
+
+    Input();
+
+    /**
+     * finishes a recording still running
+     */
+    ~Input();
+
+    Input(const Input&) = delete;
+
+    Input& operator=(const Input&) = delete;
+
+    /**
+     * producer side, the callbacks. when the ring is full the event is dropped and counted
+     */
+    void push(const InputEvent& event);
+
+    /**
+     * consumer side, once per frame. advances the clock, then takes in the events
+     */
+    void update();
+
+    /**
+     * seconds, the sum of every step so far. a replay starts at the time its recording did
+     */
+    double time() const;
+
+    /**
+     * the step the last update() advanced time() by. on the wall clock the first frame's is 0
+     */
+    double delta_time() const;
+
+    /**
+     * update() calls so far
+     */
+    std::uint64_t frame() const;
+
+    /**
+     * every update() advances time() by exactly this much instead of the time since the last one. 0 goes back to
+     * the wall clock. recording with a fixed step makes the recorded session independent of the machine too
+     */
+    void set_fixed_step(double seconds);
+
+    /**
+     * from the next update() on, every frame goes to the file. start it with nothing held, or the replay
+     * begins with those keys down but without the press
+     * @return false if the file couldn't be opened
+     */
+    bool start_recording(const std::string& path);
+
+    /**
+     * @return false if anything failed to write
+     */
+    bool stop_recording();
+
+    bool recording() const;
+
+    /**
+     * from the next update() on, frames come from the file until it runs out, then from the window again
+     * @return false if the file couldn't be read
+     */
+    bool start_replay(const std::string& path);
+
+    void stop_replay();
+
+    bool replaying() const;
+
+    const InputState& state() const;
+
+    /**
+     * everything update() drained, in order
+     */
+    std::span<const InputEvent> events() const;
+
+    /**
+     * called from update() for every event of that type. listeners may add and remove listeners, one added
+     * during update() gets the events from the next one on
+     * @return id for remove_listener
+     */
+    int add_listener(InputEventType type, Listener listener);
+
+    void remove_listener(int id);
+
+    /**
+     * events lost because update() wasn't called for a while
+     */
+    std::uint64_t dropped() const;
+
+private:
+    struct Registration {
+        int id;
+        InputEventType type;
+        Listener listener;
+        bool removed; // by a listener during dispatch, erased once it's over
+    };
+
+    double next_step();
+
+    SpscRing<InputEvent, capacity> _ring;
+    std::atomic<std::uint64_t> _dropped{0};
+    InputState _state;
+    std::vector<InputEvent> _events;
+    std::vector<Registration> _listeners;
+    std::vector<Registration> _added; // by a listener during dispatch, joins _listeners after it
+    bool _dispatching = false;
+    int _next_id = 0;
+
+    double _time = 0.0;
+    double _delta_time = 0.0;
+    double _last_clock = -1.0; // glfwGetTime at the last update, negative before the first
+    double _fixed_step = 0.0;
+    std::uint64_t _frame = 0;
+    std::unique_ptr<InputRecorder> _recorder;
+    std::unique_ptr<InputReplay> _replay;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_INPUT_H
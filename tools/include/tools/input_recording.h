@@ -0,0 +1,90 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_INPUT_RECORDING_H
+#define OPENGL_GEMINI_GUIDANCE_INPUT_RECORDING_H
+
+#include "tools/input.h"
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace tools {
+
+/**
+ * Writes a session one frame at a time: the step the frame advanced time by and the events it took in.
+ * the file is a header (magic, version, start time, the events that rebuild the snapshot recording started from)
+ * then per frame the step, an event count and the events as they are in memory. little endian hosts only,
+ * it's for replaying on the machine it was made on, not for shipping.
+ */
+class InputRecorder {
+public:
+    /**
+     * @param initial events that rebuild the state at the first frame, see InputState::as_events
+     */
+    InputRecorder(const std::string& path, double start_time, std::span<const InputEvent> initial);
+
+    InputRecorder(const InputRecorder&) = delete;
+
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    void write_frame(double step, std::span<const InputEvent> events);
+
+    /**
+     * flushes and closes, no write_frame() after this
+     * @return ok()
+     */
+    bool finish();
+
+    /**
+     * false once the file failed to open or write
+     */
+    bool ok() const;
+
+    std::uint64_t frames_written() const;
+
+private:
+    std::ofstream _file;
+    std::string _path;
+    bool _failed = false;
+    std::uint64_t _frames = 0;
+};
+
+/**
+ * A file InputRecorder wrote, read and checked up front so a truncated one fails before the first frame
+ */
+class InputReplay {
+public:
+    explicit InputReplay(const std::string& path);
+
+    bool ok() const;
+
+    double start_time() const;
+
+    std::span<const InputEvent> initial() const;
+
+    /**
+     * the next frame's step and events, replacing what's in events
+     * @return false after the last frame
+     */
+    bool next(double& step, std::vector<InputEvent>& events);
+
+    std::uint64_t frame_count() const;
+
+private:
+    struct Frame {
+        double step;
+        std::size_t first;
+        std::size_t count;
+    };
+
+    bool _ok = false;
+    double _start_time = 0.0;
+    std::vector<InputEvent> _initial;
+    std::vector<Frame> _frames;
+    std::vector<InputEvent> _events; // every frame's, back to back
+    std::size_t _next = 0;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_INPUT_RECORDING_H
@@ -0,0 +1,155 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_JOB_SYSTEM_H
+#define OPENGL_GEMINI_GUIDANCE_JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tools {
+
+class JobSystem;
+
+/**
+ * Counts the jobs run in it that haven't finished. wait on it, or hang continuations off it with JobSystem::then.
+ * it has to outlive its jobs, JobSystem::wait before it goes out of scope.
+ */
+class JobGroup {
+public:
+    JobGroup() = default;
+
+    JobGroup(const JobGroup&) = delete;
+
+    JobGroup& operator=(const JobGroup&) = delete;
+
+    bool done() const;
+
+private:
+    friend class JobSystem;
+
+    struct Continuation {
+        std::function<void()> work;
+        JobGroup* group;
+    };
+
+    mutable std::mutex _mutex; // the last job to finish still holds it, so done() can't see 0 before it let go
+    std::size_t _pending = 0;
+    std::vector<Continuation> _continuations; // queued when _pending gets to 0
+};
+
+/**
+ * One set of worker threads for the whole library, instead of every subsystem starting its own.
+ * every worker has its own deque: jobs run from a worker go on its deque and it takes the newest first
+ * (still in cache), idle workers steal the oldest from the others. jobs from any other thread go on a shared
+ * deque. waiting doesn't block a thread, wait() runs queued jobs until the group is done, so jobs can
+ * wait on jobs. dependencies are continuations (then), there are no fibers.
+ */
+class JobSystem {
+public:
+    /**
+     * @param worker_count 0 is one less than the hardware threads, the thread calling wait() makes up the last
+     */
+    explicit JobSystem(unsigned int worker_count = 0);
+
+    /**
+     * runs whatever is still queued, then joins
+     */
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * the instance the library uses by default, started on first use
+     */
+    static JobSystem& shared();
+
+    void run(JobGroup& group, std::function<void()> job);
+
+    /**
+     * queues job into group once everything in dependency has finished, right away if it already has
+     */
+    void then(JobGroup& dependency, JobGroup& group, std::function<void()> job);
+
+    /**
+     * runs queued jobs on the calling thread until the group is done, sleeps when there are none
+     */
+    void wait(JobGroup& group);
+
+    /**
+     * runs one queued job on the calling thread, for waiting on something that isn't a group
+     * @return false if nothing was queued
+     */
+    bool run_one();
+
+    /**
+     * body(first, last) over [begin, end) in chunks of grain, one of them on the calling thread.
+     * returns when all of them did
+     * @param grain 0 makes about four chunks per thread
+     */
+    template<typename Body>
+    void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, Body&& body) {
+        if (begin >= end) {
+            return;
+        }
+        const std::size_t count = end - begin;
+        if (grain == 0) {
+            const std::size_t chunks = (static_cast<std::size_t>(worker_count()) + 1) * 4;
+            grain = (count + chunks - 1) / chunks;
+        }
+        if (count <= grain || worker_count() == 0) {
+            body(begin, end);
+            return;
+        }
+
+        JobGroup group;
+        for (std::size_t first = begin + grain; first < end; first += grain) {
+            const std::size_t last = std::min(first + grain, end);
+            run(group, [&body, first, last] {
+                body(first, last);
+            });
+        }
+        body(begin, begin + grain);
+        wait(group);
+    }
+
+    unsigned int worker_count() const;
+
+private:
+    struct Job {
+        std::function<void()> work;
+        JobGroup* group;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void push(Job job);
+
+    bool try_pop(Job& job);
+
+    void finish(JobGroup& group);
+
+    void worker_loop(unsigned int index);
+
+    std::vector<std::unique_ptr<Queue>> _queues; // one per worker, the last for every other thread
+    std::atomic<std::size_t> _queued{0}; // counted before a job is pushed, so it may run ahead of the deques
+
+    std::mutex _sleep_mutex;
+    std::condition_variable _wake; // new jobs, finished groups, stopping
+    bool _stopping = false;
+    std::vector<std::thread> _workers;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_JOB_SYSTEM_H
@@ -0,0 +1,68 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_LOD_H
+#define OPENGL_GEMINI_GUIDANCE_LOD_H
+
+#include "tools/geometry_pool.h"
+#include "tools/mesh.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace tools {
+
+/**
+ * Quadric error metric simplification (Garland & Heckbert), edge collapses onto existing vertices only,
+ * so every level indexes the same vertex buffer and a LOD is just another index list.
+ * collapses that would flip a triangle are skipped. vertices on open borders and on attribute seams
+ * (one position, several uvs/normals) never move, so borders and uv seams don't crack.
+ * @param target_index_count stops once the list is this short, or nothing cheap enough is left
+ * @param max_error the largest error (in mesh units, roughly the distance from the original surface) allowed
+ * @param result_error the error of the result, same units
+ */
+std::vector<std::uint32_t> simplify(std::span<const std::uint32_t> indices, std::span<const Vertex> vertices,
+                                    std::size_t target_index_count, float max_error = 1e30f,
+                                    float* result_error = nullptr);
+
+struct LodLevel {
+    std::vector<std::uint32_t> indices;
+    std::vector<SubMesh> sub_meshes;
+    float error; // mesh units, 0 for the full mesh
+};
+
+/**
+ * level 0 is the mesh itself, every next level aims for `reduction` of the previous triangle count.
+ * sub meshes are simplified one by one so materials keep their ranges. stops early when a level
+ * barely gets smaller. every level is cache optimized.
+ */
+std::vector<LodLevel> build_lod_chain(const Mesh& mesh, int max_levels = 5, float reduction = 0.5f);
+
+/**
+ * a LOD chain living in a GeometryPool: one handle per level, all sharing level 0's vertices
+ */
+struct LodChain {
+    std::vector<int> handles;
+    std::vector<float> errors;
+};
+
+/**
+ * adds the mesh and every extra level's indices to the pool
+ */
+LodChain add_lod_chain(GeometryPool& pool, const Mesh& mesh, int max_levels = 5, float reduction = 0.5f);
+
+/**
+ * how many pixels one mesh unit covers at `distance`, with a perspective projection
+ */
+float pixels_per_unit(const glm::mat4& projection, float viewport_height, float distance);
+
+/**
+ * The coarsest level whose error stays under `pixel_threshold` on screen.
+ * hysteresis keeps objects near a switching distance from flickering between levels: going coarser needs
+ * the error to be `hysteresis` under the threshold, going finer needs the current level to be that much over it.
+ * @param current the level used last frame
+ */
+int select_lod(std::span<const float> errors, float pixels_per_unit, int current, float pixel_threshold = 1.0f,
+               float hysteresis = 0.25f);
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_LOD_H
@@ -0,0 +1,42 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_MAPPED_FILE_H
+#define OPENGL_GEMINI_GUIDANCE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace tools {
+
+/**
+ * Read-only mmap of a whole file. the pages are read in by the kernel as they are touched,
+ * nothing is copied into our own buffers.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool valid() const;
+
+    const char* data() const;
+
+    std::size_t size() const;
+
+private:
+    void unmap();
+
+    const char* _data = nullptr;
+    std::size_t _size = 0;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_MAPPED_FILE_H
@@ -0,0 +1,136 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_MESH_H
+#define OPENGL_GEMINI_GUIDANCE_MESH_H
+
+#include "glad/glad.h"
+#include "tools/job_system.h"
+#include "tools/vertex_layout.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tools {
+
+// interleaved, 32 bytes. attribute locations: 0 position, 1 normal, 2 uv
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
+/**
+ * The same vertex in 16 bytes, for static meshes where the bandwidth matters more than the last bits.
+ * position: 3 half floats (+ 2 bytes padding), exact to ~3 significant digits, fine for model space.
+ * normal: octahedral encoded into 2 snorm16, decode in the vertex shader with
+ *     vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+ *     if (n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * sign(n.xy);
+ *     n = normalize(n);
+ * uv: 2 half floats, so tiling (uv > 1) still works
+ */
+struct CompactVertex {
+    std::uint16_t position[4];
+    std::int16_t normal[2];
+    std::uint16_t uv[2];
+};
+
+static_assert(sizeof(CompactVertex) == 16, "CompactVertex must stay 16 bytes");
+
+enum class VertexFormat {
+    full,    // Vertex, 32 bytes
+    compact  // CompactVertex, 16 bytes
+};
+
+VertexLayout vertex_layout(VertexFormat format);
+
+std::uint16_t float_to_half(float value);
+
+float half_to_float(std::uint16_t value);
+
+/**
+ * unit vector -> 2 snorm16 octahedral coordinates
+ */
+void encode_octahedral(const glm::vec3& normal, std::int16_t* out);
+
+glm::vec3 decode_octahedral(const std::int16_t* encoded);
+
+std::vector<CompactVertex> quantize_vertices(const std::vector<Vertex>& vertices);
+
+struct SubMesh {
+    std::uint32_t index_offset;
+    std::uint32_t index_count;
+};
+
+struct Mesh {
+    std::vector<Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+    std::vector<SubMesh> sub_meshes;
+
+    /**
+     * true when every index fits in 16 bits, which halves the index buffer
+     */
+    bool fits_16bit_indices() const;
+
+    /**
+     * the index buffer as it should be uploaded, 16 bit when it fits
+     * @param index_type GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+     */
+    std::vector<std::uint8_t> packed_indices(GLenum& index_type) const;
+};
+
+/**
+ * Wavefront OBJ. positions, uvs and normals, polygons get fan triangulated.
+ * the file is mmapped and tokenized in place, identical v/vt/vn triples are merged into one vertex.
+ * a new sub mesh starts on every `o`, `g` and `usemtl`.
+ */
+bool load_obj(const std::string& path, Mesh& out);
+
+/**
+ * glTF 2.0, .gltf with external .bin buffers or a single .glb.
+ * buffers are mmapped and the accessors read straight out of the mapping.
+ * every triangle primitive of every mesh becomes a sub mesh. node transforms are not applied.
+ */
+bool load_gltf(const std::string& path, Mesh& out);
+
+/**
+ * picks the loader by extension
+ */
+bool load_mesh(const std::string& path, Mesh& out);
+
+/**
+ * load_mesh on every path, one job each
+ * @param out resized to paths.size(), a mesh that failed stays empty
+ * @return false if any failed
+ */
+bool load_meshes(const std::vector<std::string>& paths, std::vector<Mesh>& out, JobSystem& jobs = JobSystem::shared());
+
+/**
+ * VAO + VBO + EBO of one mesh
+ */
+class MeshBuffers {
+public:
+    /**
+     * @param format compact quantizes the vertices on the way to the GPU
+     */
+    explicit MeshBuffers(const Mesh& mesh, VertexFormat format = VertexFormat::full);
+
+    ~MeshBuffers();
+
+    MeshBuffers(const MeshBuffers&) = delete;
+
+    MeshBuffers& operator=(const MeshBuffers&) = delete;
+
+    void draw() const;
+
+    void draw(const SubMesh& sub_mesh) const;
+
+private:
+    unsigned int _vao = 0;
+    unsigned int _vbo = 0;
+    unsigned int _ebo = 0;
+    GLsizei _index_count = 0;
+    GLenum _index_type = GL_UNSIGNED_INT;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_MESH_H
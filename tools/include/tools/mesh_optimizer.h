@@ -0,0 +1,43 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_MESH_OPTIMIZER_H
+#define OPENGL_GEMINI_GUIDANCE_MESH_OPTIMIZER_H
+
+#include "tools/mesh.h"
+#include <cstdint>
+#include <span>
+
+namespace tools {
+
+/**
+ * Reorders triangles so vertices get reused while they are still in the post-transform cache.
+ * Tom Forsyth's linear-speed algorithm: every vertex is scored by its cache position and by how many
+ * triangles still need it, and the best scored triangle among the cached vertices goes next.
+ */
+void optimize_vertex_cache(std::span<std::uint32_t> indices, std::size_t vertex_count);
+
+/**
+ * Reorders clusters of an already cache optimized index list so outward facing clusters come first,
+ * and later fragments fail the depth test instead of being shaded twice.
+ * clusters break where the triangle order restarts the cache anyway, so the cache efficiency mostly survives.
+ */
+void optimize_overdraw(std::span<std::uint32_t> indices, std::span<const Vertex> vertices);
+
+/**
+ * Reorders the vertices in the order the index buffer first touches them, so vertex fetch reads memory
+ * front to back. vertices nothing references are dropped.
+ */
+void optimize_vertex_fetch(Mesh& mesh);
+
+/**
+ * Average cache miss ratio, transformed vertices per triangle with a FIFO cache (the usual hardware model).
+ * 3 is the worst, ~0.5-0.7 is what good orders get on regular meshes.
+ */
+float average_cache_miss_ratio(std::span<const std::uint32_t> indices, std::size_t vertex_count, int cache_size = 16);
+
+/**
+ * cache order and (optionally) overdraw order per sub mesh, then fetch order for the whole mesh
+ */
+void optimize_mesh(Mesh& mesh, bool overdraw = false);
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_MESH_OPTIMIZER_H
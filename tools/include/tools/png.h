@@ -0,0 +1,24 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_PNG_H
+#define OPENGL_GEMINI_GUIDANCE_PNG_H
+
+#include "tools/texture.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tools {
+
+/**
+ * 8 bit PNG of a 1-4 channel image, rows top to bottom (as load_image gives them without flipping).
+ * our own small encoder: per row filters picked by the usual minimum sum heuristic, then a fixed huffman
+ * deflate with a short hash chain (stored as is when that doesn't help). flat renders shrink a lot,
+ * photos come out bigger than zlib would make them.
+ * @return empty if the image is empty or has an unsupported channel count
+ */
+std::vector<std::uint8_t> encode_png(const Image& image);
+
+bool write_png(const std::string& path, const Image& image);
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_PNG_H
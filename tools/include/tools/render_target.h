@@ -0,0 +1,48 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_RENDER_TARGET_H
+#define OPENGL_GEMINI_GUIDANCE_RENDER_TARGET_H
+
+#include "glad/glad.h"
+
+namespace tools {
+
+/**
+ * A framebuffer object with an RGBA8 colour texture and a depth/stencil renderbuffer.
+ * the offscreen stand-in for a window's default framebuffer.
+ */
+class RenderTarget {
+public:
+    RenderTarget(int width, int height);
+
+    ~RenderTarget();
+
+    RenderTarget(const RenderTarget&) = delete;
+
+    RenderTarget& operator=(const RenderTarget&) = delete;
+
+    /**
+     * binds it for drawing and sets the viewport to cover it
+     */
+    void bind() const;
+
+    bool valid() const;
+
+    int width() const;
+
+    int height() const;
+
+    unsigned int framebuffer() const;
+
+    unsigned int colour_texture() const;
+
+private:
+    int _width;
+    int _height;
+    unsigned int _framebuffer = 0;
+    unsigned int _colour = 0;
+    unsigned int _depth_stencil = 0;
+    bool _valid = false;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_RENDER_TARGET_H
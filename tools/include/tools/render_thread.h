@@ -0,0 +1,101 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_RENDER_THREAD_H
+#define OPENGL_GEMINI_GUIDANCE_RENDER_THREAD_H
+
+#include "tools/command_buffer.h"
+#include "tools/window.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tools {
+
+/**
+ * Takes a window's context onto its own thread, which replays recorded frames and swaps.
+ * the main thread keeps the logic and poll_events() (glfw wants events there) and records each frame into a
+ * CommandBuffer. with three buffers it can be up to two frames ahead, so its work overlaps the driver and the
+ * vsync wait in swap_buffers instead of adding to them.
+ *   RenderThread renderer(window);
+ *   while (!window.should_close()) {
+ *       update();
+ *       renderer.begin_frame().record([=] { ... GL calls ... });
+ *       renderer.submit_frame();
+ *       window.poll_events();
+ *   }
+ * any other GL call from the main thread (creating a texture, start_capture...) has to go through invoke().
+ */
+class RenderThread {
+public:
+    /**
+     * @param buffer_count 2 for double buffering, 3 for triple. the calling thread loses the context until
+     * the RenderThread is destroyed
+     */
+    explicit RenderThread(Window& window, std::size_t buffer_count = 3);
+
+    /**
+     * replays everything submitted, then hands the context back to the calling thread
+     */
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    /**
+     * the next buffer to record into, cleared. waits while the render thread is still replaying it
+     */
+    CommandBuffer& begin_frame();
+
+    /**
+     * queues the recorded buffer, the render thread replays it and swaps
+     */
+    void submit_frame();
+
+    /**
+     * runs work on the render thread after everything submitted before, and waits for it
+     */
+    void invoke(const std::function<void()>& work);
+
+    /**
+     * waits until every submitted frame has been swapped
+     */
+    void finish();
+
+    std::uint64_t frames_presented() const;
+
+private:
+    struct Job {
+        const CommandBuffer* commands;
+        bool present;
+    };
+
+    /**
+     * @return the job's number, done once _done reaches it
+     */
+    std::uint64_t queue(const CommandBuffer* commands, bool present);
+
+    void render_loop();
+
+    Window& _window;
+    std::vector<CommandBuffer> _buffers;
+    std::vector<std::uint64_t> _buffer_jobs; // the job that last used each buffer, free once it's done
+    std::size_t _recording = 0;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _work_ready; // the render thread waits for jobs
+    std::condition_variable _job_done; // begin_frame, invoke and finish wait for the render thread
+    std::deque<Job> _jobs;
+    std::uint64_t _queued = 0;
+    std::uint64_t _done = 0;
+    std::uint64_t _presented = 0;
+    bool _stopping = false;
+    std::thread _thread;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_RENDER_THREAD_H
@@ -0,0 +1,69 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_SAMPLER_CACHE_H
+#define OPENGL_GEMINI_GUIDANCE_SAMPLER_CACHE_H
+
+#include "glad/glad.h"
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace tools {
+
+struct SamplerDesc {
+    GLint wrap_s = GL_REPEAT;
+    GLint wrap_t = GL_REPEAT;
+    GLint wrap_r = GL_REPEAT;
+    GLint min_filter = GL_LINEAR_MIPMAP_LINEAR;
+    GLint mag_filter = GL_LINEAR;
+    float max_anisotropy = 1.0f; // clamped to what the driver supports, 1 disables it
+    float lod_bias = 0.0f;
+
+    bool operator==(const SamplerDesc& other) const = default;
+};
+
+struct SamplerDescHash {
+    std::size_t operator()(const SamplerDesc& desc) const;
+};
+
+/**
+ * One GL sampler object per distinct SamplerDesc.
+ * a bound sampler overrides the texture's own wrap/filter state, so the same texture can be
+ * sampled several ways without copies, and switching sampling state is a single bind.
+ */
+class SamplerCache {
+public:
+    SamplerCache() = default;
+
+    ~SamplerCache();
+
+    SamplerCache(const SamplerCache&) = delete;
+
+    SamplerCache& operator=(const SamplerCache&) = delete;
+
+    /**
+     * creates the sampler the first time a desc is seen. a NaN lod bias or anisotropy is taken as the default
+     */
+    unsigned int get(const SamplerDesc& desc);
+
+    /**
+     * binds to a texture unit, skipping the call if that unit already has this sampler
+     */
+    void bind(unsigned int unit, const SamplerDesc& desc);
+
+    /**
+     * back to the texture's own parameters
+     */
+    void unbind(unsigned int unit);
+
+    std::size_t size() const;
+
+private:
+    unsigned int create(const SamplerDesc& desc);
+
+    std::unordered_map<SamplerDesc, unsigned int, SamplerDescHash> _samplers;
+    std::vector<unsigned int> _bound; // per texture unit
+    float _max_supported_anisotropy = -1.0f; // queried lazily, needs a context
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_SAMPLER_CACHE_H
@@ -0,0 +1,116 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_SCENE_GRAPH_H
+#define OPENGL_GEMINI_GUIDANCE_SCENE_GRAPH_H
+
+#include "tools/job_system.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace tools {
+
+struct Transform {
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+};
+
+/**
+ * translate * rotate * scale, built straight from the quaternion instead of multiplying three matrices
+ */
+glm::mat4 to_matrix(const Transform& transform);
+
+/**
+ * Transform hierarchy kept as flat arrays sorted by depth, so every parent comes before its children and
+ * update() is one linear pass with no pointers to chase.
+ * a node's world matrix is only recomputed when its own local transform or one of its ancestors changed,
+ * and its local matrix only when its own transform did.
+ * node ids stay stable, the slots behind them move when the hierarchy changes.
+ */
+class SceneGraph {
+public:
+    using NodeId = std::uint32_t;
+
+    static constexpr NodeId no_parent = std::numeric_limits<NodeId>::max();
+
+    NodeId create(NodeId parent = no_parent, const Transform& local = {});
+
+    /**
+     * removes the node and everything under it, on the next update()
+     */
+    void destroy(NodeId node);
+
+    void set_local(NodeId node, const Transform& local);
+
+    void set_position(NodeId node, const glm::vec3& position);
+
+    void set_rotation(NodeId node, const glm::quat& rotation);
+
+    void set_scale(NodeId node, const glm::vec3& scale);
+
+    const Transform& local(NodeId node) const;
+
+    /**
+     * as of the last update()
+     */
+    const glm::mat4& world(NodeId node) const;
+
+    NodeId parent(NodeId node) const;
+
+    bool alive(NodeId node) const;
+
+    /**
+     * compacts and re-sorts if nodes were added out of depth order or destroyed, then refreshes the dirty
+     * world matrices.
+     * @return the number of world matrices recomputed
+     */
+    std::size_t update();
+
+    /**
+     * the same, one depth level after the other, each level split into jobs. worth it from a few thousand nodes
+     */
+    std::size_t update(JobSystem& jobs);
+
+    std::size_t size() const;
+
+    /**
+     * every world matrix in slot order, ready to upload as one buffer
+     */
+    std::span<const glm::mat4> world_matrices() const;
+
+    /**
+     * where the node's matrix is in world_matrices(), changes when the hierarchy does
+     */
+    std::uint32_t slot(NodeId node) const;
+
+private:
+    static constexpr std::uint32_t no_slot = std::numeric_limits<std::uint32_t>::max();
+
+    void rebuild();
+
+    /**
+     * refreshes the slots in [first, last), their parents have to be up to date
+     * @return the number of world matrices recomputed
+     */
+    std::size_t update_range(std::size_t first, std::size_t last);
+
+    // per slot, all in depth order
+    std::vector<std::uint32_t> _parent; // slot of the parent or no_slot
+    std::vector<std::uint32_t> _depth;
+    std::vector<Transform> _local;
+    std::vector<glm::mat4> _local_matrix;
+    std::vector<glm::mat4> _world;
+    std::vector<std::uint8_t> _dirty;
+    std::vector<std::uint8_t> _changed; // world matrix recomputed this update, children need it too
+    std::vector<NodeId> _node_of_slot;
+
+    std::vector<std::uint32_t> _slot_of_node; // no_slot once destroyed
+    std::vector<NodeId> _free_nodes;
+    bool _needs_rebuild = false;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_SCENE_GRAPH_H
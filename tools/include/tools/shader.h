@@ -22,11 +22,14 @@ public:
     template<typename T>
     void set_uniform_data(const std::string& name, const T& data);
 
+    /**
+     * whole file as a string, throws std::ifstream::failure if it can't be read
+     */
+    static std::string read_file(const std::string& path);
+
 private:
     unsigned int ID;
 
-    static std::string read_file(const std::string& path);
-
     static bool log_shader_error(unsigned int shader_index, const std::string& label);
 
     static bool log_program_error(unsigned int program_index);
@@ -39,6 +42,7 @@ extern template void Shader::set_uniform_data<glm::vec2>(const std::string&, con
 extern template void Shader::set_uniform_data<glm::vec3>(const std::string&, const glm::vec3&);
 extern template void Shader::set_uniform_data<glm::vec4>(const std::string&, const glm::vec4&);
 extern template void Shader::set_uniform_data<glm::mat3>(const std::string&, const glm::mat3&);
+extern template void Shader::set_uniform_data<glm::mat4>(const std::string&, const glm::mat4&);
 
 
 }
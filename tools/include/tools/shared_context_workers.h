@@ -0,0 +1,127 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_SHARED_CONTEXT_WORKERS_H
+#define OPENGL_GEMINI_GUIDANCE_SHARED_CONTEXT_WORKERS_H
+
+#include "tools/window.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tools {
+
+/**
+ * The handoff of one job run by SharedContextWorkers. the worker puts a fence after the job's GL commands,
+ * the thread using the result checks or waits on that fence in its own context.
+ */
+class GlJob {
+public:
+    virtual ~GlJob();
+
+    /**
+     * true once the job ran and the GPU finished its commands. doesn't block, call it with a context current
+     */
+    bool ready();
+
+    /**
+     * blocks until the job ran, then makes later commands of the current context wait for it on the GPU
+     * (glWaitSync), so the CPU doesn't wait on the upload itself. the fence is gone after the first call,
+     * later ones return right away
+     */
+    void wait();
+
+private:
+    friend class SharedContextWorkers;
+
+    void complete(GLsync fence);
+
+    std::mutex _mutex;
+    std::condition_variable _completed;
+    bool _done = false;
+    GLsync _fence = nullptr;
+};
+
+/**
+ * a GlJob making a T, e.g. a Texture or a Shader
+ */
+template<typename T>
+class GlResult : public GlJob {
+public:
+    /**
+     * waits like GlJob::wait
+     * @return nullptr if making it failed
+     */
+    T* get() {
+        wait();
+        return _value.get();
+    }
+
+private:
+    friend class SharedContextWorkers;
+
+    std::unique_ptr<T> _value;
+};
+
+/**
+ * Worker threads with hidden contexts shared with a window's, for creating GL resources off the render thread:
+ * buffer and texture uploads, shader compiles. textures, buffers, shaders and programs are shared between the
+ * contexts, VAOs and framebuffers aren't, make those where they're used.
+ *   auto texture = workers.create<Texture>([] { return std::make_unique<Texture>("big.png"); });
+ *   ... while (!texture->ready()) keep rendering without it ...
+ *   texture->get()->bind(0);
+ */
+class SharedContextWorkers {
+public:
+    /**
+     * creates the contexts, call it on the main thread (glfw creates windows only there)
+     */
+    explicit SharedContextWorkers(Window& window, unsigned int worker_count = 1);
+
+    /**
+     * finishes the queued jobs, then destroys the contexts. on the main thread too
+     */
+    ~SharedContextWorkers();
+
+    SharedContextWorkers(const SharedContextWorkers&) = delete;
+
+    SharedContextWorkers& operator=(const SharedContextWorkers&) = delete;
+
+    /**
+     * runs job on a worker with its context current
+     */
+    std::shared_ptr<GlJob> submit(std::function<void()> job);
+
+    template<typename T>
+    std::shared_ptr<GlResult<T>> create(std::function<std::unique_ptr<T>()> make) {
+        auto result = std::make_shared<GlResult<T>>();
+        enqueue(result, [result, make = std::move(make)] {
+            result->_value = make();
+        });
+        return result;
+    }
+
+private:
+    struct Job {
+        std::shared_ptr<GlJob> handoff;
+        std::function<void()> work;
+    };
+
+    void enqueue(std::shared_ptr<GlJob> handoff, std::function<void()> work);
+
+    void worker_loop(GLFWwindow* context);
+
+    Window& _window;
+    std::vector<GLFWwindow*> _contexts;
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<Job> _jobs;
+    bool _stopping = false;
+    std::vector<std::thread> _workers;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_SHARED_CONTEXT_WORKERS_H
@@ -0,0 +1,108 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_SOFTWARE_RASTERIZER_H
+#define OPENGL_GEMINI_GUIDANCE_SOFTWARE_RASTERIZER_H
+
+#include "tools/job_system.h"
+#include "tools/sampler_cache.h"
+#include "tools/texture.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace tools {
+
+struct RasterVertex {
+    glm::vec4 position{0.0f, 0.0f, 0.0f, 1.0f}; // multiplied by RasterDraw::transform, the result is clip space
+    glm::vec4 colour{1.0f};
+    glm::vec2 uv{0.0f};
+};
+
+/**
+ * the fragment shaders this renderer can stand in for, it doesn't run GLSL
+ */
+enum class Shading {
+    constant, // RasterDraw::colour
+    vertex_colour, // interpolated vertex colour (03_coloured_triangle's fragment shader)
+    texture, // textures[0]
+    texture_mix // mix(textures[0], textures[1], mix) (fragment_two_textures.frag)
+};
+
+struct RasterDraw {
+    glm::mat4 transform{1.0f};
+    Shading shading = Shading::vertex_colour;
+    glm::vec4 colour{1.0f};
+    /**
+     * must stay alive until finish(). sampled bilinear (nearest with a GL_NEAREST mag filter) with the
+     * sampler's wrap_s / wrap_t, no mipmaps. row 0 is t = 0, as after a GL upload
+     */
+    const Image* textures[2] = {nullptr, nullptr};
+    SamplerDesc samplers[2];
+    float mix = 0.2f;
+};
+
+/**
+ * CPU reference renderer for the simple pipelines in this repo, for golden images and machines without any GL.
+ * tile based: draw() clips, sets up and bins triangles into 64x64 tiles, finish() rasterizes the tiles as
+ * jobs, each tile in submission order. edge functions are evaluated exactly (vertices snapped to
+ * 1/256 pixel, doubles), four pixels at a time with AVX2, with the top-left fill rule, so shared edges
+ * have no gaps or double hits and the output is the same on every machine and thread count.
+ * no depth test and no blending, later triangles overwrite earlier ones, as in the demos.
+ */
+class SoftwareRasterizer {
+public:
+    /**
+     * @param width, height up to 4096
+     * @param jobs nullptr rasterizes on the calling thread
+     */
+    SoftwareRasterizer(int width, int height, JobSystem* jobs = &JobSystem::shared());
+
+    ~SoftwareRasterizer();
+
+    /**
+     * anything drawn before and not finished yet is dropped
+     */
+    void clear(const glm::vec4& colour);
+
+    /**
+     * @param indices triangle list, empty draws the vertices in order
+     */
+    void draw(std::span<const RasterVertex> vertices, std::span<const std::uint32_t> indices, const RasterDraw& draw);
+
+    /**
+     * rasterizes everything drawn since the last finish()
+     */
+    void finish();
+
+    /**
+     * RGBA8, top row first like FrameCapture's frames. call finish() first
+     */
+    const Image& image() const;
+
+    int width() const;
+
+    int height() const;
+
+    struct Triangle; // set up for rasterization, only defined in the source
+
+private:
+    void setup(const RasterVertex* corners, std::uint32_t draw);
+
+    void rasterize_tile(int tile);
+
+    int _width;
+    int _height;
+    int _tiles_x;
+    int _tiles_y;
+    JobSystem* _jobs;
+    Image _image;
+
+    bool _clear_pending = false;
+    std::uint8_t _clear_colour[4] = {0, 0, 0, 0};
+    std::vector<RasterDraw> _draws;
+    std::vector<Triangle> _triangles;
+    std::vector<std::vector<std::uint32_t>> _bins; // triangle indices per tile, in submission order
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_SOFTWARE_RASTERIZER_H
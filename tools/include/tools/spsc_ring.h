@@ -0,0 +1,57 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_SPSC_RING_H
+#define OPENGL_GEMINI_GUIDANCE_SPSC_RING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace tools {
+
+/**
+ * Fixed size lock-free queue for exactly one producer thread and one consumer thread.
+ * the indices only grow, a slot is index & (Capacity - 1). each side writes only its own index,
+ * the release store publishes the slot, the other side's acquire load sees it.
+ */
+template<typename T, std::size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    /**
+     * producer only
+     * @return false when full, the value is not queued
+     */
+    bool push(const T& value) {
+        const std::size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        _slots[head & (Capacity - 1)] = value;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * consumer only
+     * @return false when empty
+     */
+    bool pop(T& value) {
+        const std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = _slots[tail & (Capacity - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // on their own cache lines, or every push and pop would bounce one line between the two threads
+    alignas(64) std::atomic<std::size_t> _head{0};
+    alignas(64) std::atomic<std::size_t> _tail{0};
+    std::array<T, Capacity> _slots{};
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_SPSC_RING_H
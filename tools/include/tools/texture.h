@@ -0,0 +1,101 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_TEXTURE_H
+#define OPENGL_GEMINI_GUIDANCE_TEXTURE_H
+
+#include "glad/glad.h"
+#include "tools/block_compression.h"
+#include <string>
+#include <vector>
+
+namespace tools {
+
+struct Image {
+    std::vector<unsigned char> pixels;
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+};
+
+/**
+ * Decodes an image file with stb.
+ * @param desired_channels 0 keeps whatever the file has
+ * @return false if the file couldn't be decoded
+ */
+bool load_image(const std::string& path, Image& out, bool flip_vertically = false, int desired_channels = 0);
+
+/**
+ * 2x2 box filter, keeps the channel count. odd sizes repeat their last row/column.
+ */
+Image half_size(const Image& image);
+
+struct TextureFormat {
+    GLenum internal_format; // sized, as glTexStorage2D wants it
+    GLenum format;
+};
+
+/**
+ * Picks the smallest format that holds `channels`.
+ * 1 and 2 channel images stay GL_R8/GL_RG8 instead of being inflated to RGBA.
+ * core GL has no sRGB one/two channel formats, so those stay linear.
+ */
+TextureFormat texture_format_for(int channels, bool srgb);
+
+int mip_count(int width, int height);
+
+struct TextureDesc {
+    bool srgb = false; // colour data (albedo, UI) should be sRGB, data textures (normals, masks) shouldn't
+    bool mipmaps = true;
+    bool flip_vertically = false;
+    GLint wrap_s = GL_REPEAT;
+    GLint wrap_t = GL_REPEAT;
+};
+
+class Texture {
+public:
+    Texture(const std::string& path, const TextureDesc& desc = {});
+
+    Texture(const Image& image, const TextureDesc& desc = {});
+
+    /**
+     * Uploads pre-compressed levels as they are. srgb comes from the image and no mips are generated,
+     * so only the wrap settings of `desc` are used.
+     */
+    Texture(const CompressedImage& image, const TextureDesc& desc = {});
+
+    ~Texture();
+
+    Texture(const Texture&) = delete;
+
+    Texture& operator=(const Texture&) = delete;
+
+    Texture(Texture&& other) noexcept;
+
+    Texture& operator=(Texture&& other) noexcept;
+
+    void bind(unsigned int unit) const;
+
+    bool valid() const;
+
+    unsigned int id() const;
+
+    int width() const;
+
+    int height() const;
+
+    TextureFormat format() const;
+
+private:
+    void upload(const Image& image, const TextureDesc& desc);
+
+    void upload(const CompressedImage& image, const TextureDesc& desc);
+
+    void allocate(int levels);
+
+    unsigned int _id = 0;
+    int _width = 0;
+    int _height = 0;
+    TextureFormat _format{GL_RGBA8, GL_RGBA};
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_TEXTURE_H
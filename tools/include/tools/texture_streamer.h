@@ -0,0 +1,135 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_TEXTURE_STREAMER_H
+#define OPENGL_GEMINI_GUIDANCE_TEXTURE_STREAMER_H
+
+#include "glad/glad.h"
+#include "tools/block_compression.h"
+#include "tools/job_system.h"
+#include "tools/texture.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tools {
+
+/**
+ * Keeps only the mips that are actually visible on the GPU.
+ *
+ * every texture starts with just its small tail mips. the caller reports how big each texture is on screen,
+ * jobs load the missing finer levels (a .dds only reads the levels it needs, anything else is
+ * decoded and downsampled), and `update()` uploads them on the GL thread.
+ * GL_TEXTURE_BASE_LEVEL is clamped to the finest resident level so sampling never touches a missing one.
+ * when the budget is exceeded, the finest levels of the least recently used textures are dropped first.
+ *
+ * these are mutable (glTexImage2D) textures on purpose: immutable storage would allocate every level up front.
+ */
+class TextureStreamer {
+public:
+    /**
+     * @param budget_bytes GPU memory for all streamed levels together
+     * @param tail_size levels this size and smaller are loaded up front and never evicted
+     * @param jobs runs the loads
+     */
+    explicit TextureStreamer(std::size_t budget_bytes, int tail_size = 64, JobSystem& jobs = JobSystem::shared());
+
+    ~TextureStreamer();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    /**
+     * @return handle, or -1 if the file can't be read
+     */
+    int add(const std::string& path, const TextureDesc& desc = {});
+
+    /**
+     * screen-space feedback, call it every frame the texture is drawn.
+     * @param pixels the largest on-screen extent the texture covers this frame
+     */
+    void report_screen_size(int handle, float pixels);
+
+    /**
+     * GL thread only, once per frame after the draws (and their reports).
+     * uploads finished loads, evicts over budget and schedules new loads.
+     */
+    void update();
+
+    /**
+     * a grey 1x1 placeholder until the tail mips have arrived
+     */
+    unsigned int texture(int handle) const;
+
+    void bind(int handle, unsigned int unit) const;
+
+    int resident_level(int handle) const;
+
+    std::size_t resident_bytes() const;
+
+private:
+    struct Entry {
+        std::string path;
+        bool compressed;
+        bool flip_vertically;
+        BlockFormat block_format;
+        TextureFormat format;
+        int width;
+        int height;
+        int channels;
+        int levels;
+        int tail_level;
+        unsigned int id = 0;
+        int resident_base;      // finest level on the GPU, == levels while nothing is
+        int wanted_level;
+        int pending_level = -1; // first level of the load in flight
+        std::uint64_t last_used = 0;
+    };
+
+    struct Job {
+        int handle;
+        std::string path;
+        bool compressed;
+        bool flip_vertically;
+        int first_level;
+        int last_level;
+    };
+
+    struct LoadedLevels {
+        int handle;
+        int first_level;
+        std::vector<std::vector<unsigned char>> levels;
+    };
+
+    void load(const Job& job);
+
+    static bool load_levels(const Job& job, LoadedLevels& out);
+
+    void schedule(int handle, int first_level, int last_level);
+
+    void upload(const LoadedLevels& loaded);
+
+    void evict_level(Entry& entry);
+
+    void enforce_budget();
+
+    std::size_t level_bytes(const Entry& entry, int level) const;
+
+    std::size_t _budget;
+    int _tail_size;
+    std::uint64_t _frame = 0;
+    std::size_t _resident_bytes = 0;
+    unsigned int _placeholder = 0;
+    std::vector<Entry> _entries;
+
+    JobSystem& _job_system;
+    JobGroup _loads;
+    std::atomic<bool> _stopping{false}; // loads still queued skip their work
+
+    std::mutex _mutex;
+    std::vector<LoadedLevels> _finished;
+};
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_TEXTURE_STREAMER_H
@@ -0,0 +1,59 @@
+#ifndef OPENGL_GEMINI_GUIDANCE_VERTEX_LAYOUT_H
+#define OPENGL_GEMINI_GUIDANCE_VERTEX_LAYOUT_H
+
+#include "glad/glad.h"
+#include <vector>
+
+namespace tools {
+
+struct VertexAttribute {
+    GLuint location;
+    GLint components;
+    GLenum type; // GL_FLOAT, GL_HALF_FLOAT, GL_UNSIGNED_BYTE, GL_SHORT...
+    GLboolean normalized;
+    GLuint offset;
+};
+
+/**
+ * Builds an interleaved layout attribute by attribute, offsets and stride are worked out as we go.
+ * e.g. the 32 byte layout of the texture demos:
+ *     VertexLayout().add(0, 3, GL_FLOAT).add(1, 3, GL_FLOAT).add(2, 2, GL_FLOAT)
+ * and the same data in 16 bytes:
+ *     VertexLayout().add(0, 3, GL_HALF_FLOAT).pad(2).add(1, 4, GL_UNSIGNED_BYTE, true).add(2, 2, GL_HALF_FLOAT)
+ */
+class VertexLayout {
+public:
+    VertexLayout& add(GLuint location, GLint components, GLenum type, bool normalized = false);
+
+    /**
+     * skips bytes, mostly to keep the next attribute 4 byte aligned
+     */
+    VertexLayout& pad(GLuint bytes);
+
+    /**
+     * glVertexAttribPointer + enable for every attribute. needs the VAO and the GL_ARRAY_BUFFER bound.
+     */
+    void apply(GLintptr base_offset = 0) const;
+
+    /**
+     * separate attribute format (4.3): the layout goes into the VAO once and buffers are attached
+     * to `binding` with glBindVertexBuffer, so one VAO serves every buffer with this layout.
+     */
+    void apply_format(GLuint binding) const;
+
+    GLsizei stride() const;
+
+    const std::vector<VertexAttribute>& attributes() const;
+
+    bool operator==(const VertexLayout& other) const;
+
+private:
+    std::vector<VertexAttribute> _attributes;
+    GLuint _stride = 0;
+};
+
+GLuint attribute_type_size(GLenum type);
+
+} // tools
+
+#endif //OPENGL_GEMINI_GUIDANCE_VERTEX_LAYOUT_H
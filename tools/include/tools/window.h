@@ -2,7 +2,13 @@
 #define OPENGL_GEMINI_GUIDANCE_WINDOW_H
 
 #include "glad/glad.h"
+#include "tools/frame_capture.h"
+#include "tools/frame_exporter.h"
+#include "tools/input.h"
 #include <GLFW/glfw3.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 
 namespace tools {
@@ -10,22 +16,89 @@ namespace tools {
 
 class Window {
 public:
-    Window(int height, int width, const std::string& window_name);
+    /**
+     * @param gl_major, gl_minor the core context to ask for. 3.3 is enough for the exercises,
+     * multi draw indirect and storage buffers need 4.3
+     */
+    Window(int height, int width, const std::string& window_name, int gl_major = 3, int gl_minor = 3);
     ~Window();
 
     void make_current();
 
+    /**
+     * a hidden window whose context shares this one's textures, buffers and programs, for another thread
+     * to make current (see SharedContextWorkers). main thread only, like every glfw window call
+     * @return nullptr if it couldn't be created
+     */
+    GLFWwindow* create_shared_context();
+
+    void destroy_shared_context(GLFWwindow* context);
+
    GLFWwindow* operator~(); //not entirely sure about this one. and then, why would i need the not on window of this object in excersize context?
-   //todo maybe add adding callbacks and input processes. so we won't need the operator overload
+   //input goes through input() now, this is left for whatever glfw call Window doesn't wrap
+
+    /**
+     * key, mouse button, cursor, scroll and resize callbacks of this window, queued by poll_events().
+     * call input().update() once per frame to take them in
+     */
+    Input& input();
+
+    const Input& input() const;
+
+    void close();
 
     bool should_close() const;
 
     void poll_events();
 
+    /**
+     * applies a resize poll_events() saw while the context was current on another thread (a RenderThread).
+     * call it where the context is current, RenderThread does before every frame
+     */
+    void update_viewport();
+
+    /**
+     * in capture mode also reads the frame back before swapping, see start_capture
+     */
     void swap_buffers();
 
+    /**
+     * Capture mode: every swap_buffers() queues a readback of the back buffer into a ring of PBOs and hands
+     * the frames that have arrived to a FrameExporter, which encodes and writes them as JobSystem jobs.
+     * the render loop only waits when the GPU is a whole ring behind, or the exporter's queue is full.
+     * the size is the framebuffer's when capture starts, don't resize while capturing.
+     * @return false if the exporter couldn't start (e.g. the pipe command)
+     */
+    bool start_capture(const ExportDesc& desc);
+
+    /**
+     * collects the frames still in flight and waits for all of them to be written
+     * @return false if any frame failed to write
+     */
+    bool stop_capture();
+
+    bool capturing() const;
+
 private:
+    static void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+
+    static void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+
+    static void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+
+    static void cursor_position_callback(GLFWwindow* window, double x, double y);
+
+    static void scroll_callback(GLFWwindow* window, double x, double y);
+
+    void capture_frame();
+
     GLFWwindow* _window;
+    int _gl_major;
+    int _gl_minor;
+    std::atomic<std::uint64_t> _pending_viewport{0}; // width << 32 | height, 0 when there's nothing to apply
+    std::unique_ptr<FrameCapture> _capture;
+    std::unique_ptr<FrameExporter> _exporter;
+    Input _input;
 };
 
 } // tools
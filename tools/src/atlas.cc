@@ -0,0 +1,237 @@
+#include "tools/atlas.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+namespace tools {
+
+SkylinePacker::SkylinePacker(int width, int height) : _width(width), _height(height) {
+    reset();
+}
+
+void SkylinePacker::reset() {
+    _skyline.clear();
+    _skyline.push_back({0, 0, _width});
+}
+
+int SkylinePacker::fit(std::size_t index, int width, int height) const {
+    const int x = _skyline[index].x;
+    if (x + width > _width) {
+        return -1;
+    }
+
+    int y = _skyline[index].y;
+    int width_left = width;
+    // the rect rests on the highest segment it spans
+    for (std::size_t i = index; width_left > 0; ++i) {
+        y = std::max(y, _skyline[i].y);
+        if (y + height > _height) {
+            return -1;
+        }
+        width_left -= _skyline[i].width;
+    }
+    return y;
+}
+
+bool SkylinePacker::pack(int width, int height, AtlasRect& out) {
+    int best_top = INT_MAX;
+    int best_width = INT_MAX;
+    std::size_t best_index = _skyline.size();
+
+    for (std::size_t i = 0; i < _skyline.size(); ++i) {
+        const int y = fit(i, width, height);
+        if (y < 0) {
+            continue;
+        }
+        const int top = y + height;
+        if (top < best_top || (top == best_top && _skyline[i].width < best_width)) {
+            best_top = top;
+            best_width = _skyline[i].width;
+            best_index = i;
+            out = {_skyline[i].x, y, width, height};
+        }
+    }
+
+    if (best_index == _skyline.size()) {
+        return false;
+    }
+
+    add_segment(best_index, out);
+    return true;
+}
+
+void SkylinePacker::add_segment(std::size_t index, const AtlasRect& rect) {
+    _skyline.insert(_skyline.begin() + static_cast<long>(index), {rect.x, rect.y + rect.height, rect.width});
+
+    // cut away whatever the new segment now covers
+    for (std::size_t i = index + 1; i < _skyline.size();) {
+        const Segment& previous = _skyline[i - 1];
+        const int previous_end = previous.x + previous.width;
+        if (_skyline[i].x >= previous_end) {
+            break;
+        }
+
+        const int shrink = previous_end - _skyline[i].x;
+        _skyline[i].x += shrink;
+        _skyline[i].width -= shrink;
+        if (_skyline[i].width > 0) {
+            break;
+        }
+        _skyline.erase(_skyline.begin() + static_cast<long>(i));
+    }
+
+    // merge neighbours on the same height
+    for (std::size_t i = 0; i + 1 < _skyline.size();) {
+        if (_skyline[i].y == _skyline[i + 1].y) {
+            _skyline[i].width += _skyline[i + 1].width;
+            _skyline.erase(_skyline.begin() + static_cast<long>(i) + 1);
+        } else {
+            ++i;
+        }
+    }
+}
+
+TextureAtlas::TextureAtlas(int width, int height, int padding)
+        : _width(width), _height(height), _padding(padding), _packer(width, height),
+          _pixels(static_cast<std::size_t>(width) * height * 4, 0) {
+}
+
+TextureAtlas::~TextureAtlas() {
+    if (_texture != 0) {
+        glDeleteTextures(1, &_texture);
+    }
+}
+
+int TextureAtlas::add_image(const std::string& path) {
+    int width, height, channels;
+    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (!data) {
+        std::cerr << "ERROR::ATLAS::FAILED_TO_LOAD: " << path << std::endl;
+        return -1;
+    }
+
+    const int id = add_image(data, width, height);
+    stbi_image_free(data);
+    return id;
+}
+
+int TextureAtlas::add_image(const unsigned char* rgba, int width, int height) {
+    AtlasRect padded{};
+    if (!_packer.pack(width + 2 * _padding, height + 2 * _padding, padded)) {
+        std::cerr << "ERROR::ATLAS::OUT_OF_SPACE: " << width << "x" << height << std::endl;
+        return -1;
+    }
+
+    blit_extruded(rgba, width, height, padded);
+
+    AtlasRegion region{};
+    region.rect = {padded.x + _padding, padded.y + _padding, width, height};
+    region.uv_min = glm::vec2(static_cast<float>(region.rect.x) / static_cast<float>(_width),
+                              static_cast<float>(region.rect.y) / static_cast<float>(_height));
+    region.uv_max = glm::vec2(static_cast<float>(region.rect.x + width) / static_cast<float>(_width),
+                              static_cast<float>(region.rect.y + height) / static_cast<float>(_height));
+    _regions.push_back(region);
+    return static_cast<int>(_regions.size()) - 1;
+}
+
+std::vector<int> TextureAtlas::add_images(const std::vector<std::string>& paths) {
+    struct Loaded {
+        unsigned char* data;
+        int width;
+        int height;
+    };
+
+    std::vector<Loaded> images(paths.size(), Loaded{nullptr, 0, 0});
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        int channels;
+        images[i].data = stbi_load(paths[i].c_str(), &images[i].width, &images[i].height, &channels, 4);
+        if (!images[i].data) {
+            std::cerr << "ERROR::ATLAS::FAILED_TO_LOAD: " << paths[i] << std::endl;
+        }
+    }
+
+    std::vector<std::size_t> order(paths.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&images](std::size_t a, std::size_t b) {
+        return images[a].height > images[b].height;
+    });
+
+    std::vector<int> ids(paths.size(), -1);
+    for (std::size_t i: order) {
+        if (images[i].data) {
+            ids[i] = add_image(images[i].data, images[i].width, images[i].height);
+            stbi_image_free(images[i].data);
+        }
+    }
+    return ids;
+}
+
+void TextureAtlas::blit_extruded(const unsigned char* rgba, int width, int height, const AtlasRect& padded) {
+    // every destination pixel samples the clamped source pixel, which copies the image and
+    // smears its edges over the padding in one go
+    for (int y = 0; y < padded.height; ++y) {
+        const int src_y = std::clamp(y - _padding, 0, height - 1);
+        const unsigned char* src_row = rgba + static_cast<std::size_t>(src_y) * width * 4;
+        unsigned char* dst_row = _pixels.data() + (static_cast<std::size_t>(padded.y + y) * _width + padded.x) * 4;
+
+        for (int x = 0; x < _padding; ++x) {
+            std::memcpy(dst_row + x * 4, src_row, 4);
+        }
+        std::memcpy(dst_row + _padding * 4, src_row, static_cast<std::size_t>(width) * 4);
+        for (int x = _padding + width; x < padded.width; ++x) {
+            std::memcpy(dst_row + x * 4, src_row + (width - 1) * 4, 4);
+        }
+    }
+}
+
+const AtlasRegion& TextureAtlas::region(int id) const {
+    return _regions[static_cast<std::size_t>(id)];
+}
+
+std::size_t TextureAtlas::size() const {
+    return _regions.size();
+}
+
+int TextureAtlas::width() const {
+    return _width;
+}
+
+int TextureAtlas::height() const {
+    return _height;
+}
+
+const std::vector<unsigned char>& TextureAtlas::pixels() const {
+    return _pixels;
+}
+
+unsigned int TextureAtlas::upload() {
+    if (_texture == 0) {
+        glGenTextures(1, &_texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, _texture);
+
+    // a mip texel covers 2^level pixels, once that is wider than the padding neighbours bleed in
+    int max_level = 0;
+    while ((2 << max_level) <= _padding) {
+        ++max_level;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, max_level);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, _pixels.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    return _texture;
+}
+
+unsigned int TextureAtlas::texture() const {
+    return _texture;
+}
+
+} // tools
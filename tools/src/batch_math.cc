@@ -0,0 +1,202 @@
+#include "tools/batch_math.h"
+#include "cpu_features.hh"
+#include <glm/gtc/type_ptr.hpp>
+#include <atomic>
+#include <cstddef>
+
+namespace tools {
+
+namespace {
+
+std::atomic<bool> avx2_enabled{true};
+
+#ifdef TOOLS_X86
+
+// "avx2" only, no "fma": with fma enabled the compiler may fuse a mul + add and the results would drift from glm
+
+/**
+ * left * two columns of the right matrix at once, glm's order: ((a0 * b0 + a1 * b1) + a2 * b2) + a3 * b3
+ */
+__attribute__((target("avx2")))
+inline __m256 multiply_columns(const __m256 left[4], __m256 columns) {
+    const __m256 x = _mm256_permute_ps(columns, 0x00);
+    const __m256 y = _mm256_permute_ps(columns, 0x55);
+    const __m256 z = _mm256_permute_ps(columns, 0xaa);
+    const __m256 w = _mm256_permute_ps(columns, 0xff);
+    __m256 sum = _mm256_add_ps(_mm256_mul_ps(left[0], x), _mm256_mul_ps(left[1], y));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(left[2], z));
+    return _mm256_add_ps(sum, _mm256_mul_ps(left[3], w));
+}
+
+__attribute__((target("avx2")))
+void multiply_avx2(const glm::mat4& left, const glm::mat4* right, glm::mat4* out, std::size_t count) {
+    __m256 columns[4];
+    for (int c = 0; c < 4; ++c) {
+        columns[c] = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(glm::value_ptr(left[c])));
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const float* source = glm::value_ptr(right[i]);
+        const __m256 first = _mm256_loadu_ps(source);
+        const __m256 second = _mm256_loadu_ps(source + 8);
+        float* destination = glm::value_ptr(out[i]);
+        _mm256_storeu_ps(destination, multiply_columns(columns, first));
+        _mm256_storeu_ps(destination + 8, multiply_columns(columns, second));
+    }
+}
+
+__attribute__((target("avx2")))
+void transform_points_avx2(const glm::mat4& matrix, const glm::vec3* points, glm::vec3* out, std::size_t count) {
+    __m256 columns[4];
+    for (int c = 0; c < 4; ++c) {
+        columns[c] = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(glm::value_ptr(matrix[c])));
+    }
+
+    std::size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const glm::vec3 a = points[i];
+        const glm::vec3 b = points[i + 1];
+        const __m256 x = _mm256_set_m128(_mm_set1_ps(b.x), _mm_set1_ps(a.x));
+        const __m256 y = _mm256_set_m128(_mm_set1_ps(b.y), _mm_set1_ps(a.y));
+        const __m256 z = _mm256_set_m128(_mm_set1_ps(b.z), _mm_set1_ps(a.z));
+        // glm's mat4 * vec4 is (m0 * x + m1 * y) + (m2 * z + m3 * w), and m3 * 1 is exactly m3
+        const __m256 result = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(columns[0], x), _mm256_mul_ps(columns[1], y)),
+                                            _mm256_add_ps(_mm256_mul_ps(columns[2], z), columns[3]));
+
+        // xyz only, a 16 byte store could run past the end or over a point not read yet
+        const __m128 low = _mm256_castps256_ps128(result);
+        const __m128 high = _mm256_extractf128_ps(result, 1);
+        _mm_storel_pi(reinterpret_cast<__m64*>(&out[i].x), low);
+        _mm_store_ss(&out[i].z, _mm_movehl_ps(low, low));
+        _mm_storel_pi(reinterpret_cast<__m64*>(&out[i + 1].x), high);
+        _mm_store_ss(&out[i + 1].z, _mm_movehl_ps(high, high));
+    }
+    for (; i < count; ++i) {
+        out[i] = glm::vec3(matrix * glm::vec4(points[i], 1.0f));
+    }
+}
+
+/**
+ * rows x, y, z, w of column `column` for 8 matrices, transposed into place. 4x4 transposes within each
+ * 128 bit half, so the low half holds matrices 0-3 and the high half 4-7
+ */
+__attribute__((target("avx2")))
+inline void store_columns(glm::mat4* out, int column, __m256 x, __m256 y, __m256 z, __m256 w) {
+    const __m256 xy_low = _mm256_unpacklo_ps(x, y);
+    const __m256 xy_high = _mm256_unpackhi_ps(x, y);
+    const __m256 zw_low = _mm256_unpacklo_ps(z, w);
+    const __m256 zw_high = _mm256_unpackhi_ps(z, w);
+    const __m256 columns[4] = {
+            _mm256_shuffle_ps(xy_low, zw_low, 0x44),
+            _mm256_shuffle_ps(xy_low, zw_low, 0xee),
+            _mm256_shuffle_ps(xy_high, zw_high, 0x44),
+            _mm256_shuffle_ps(xy_high, zw_high, 0xee),
+    };
+    for (int k = 0; k < 4; ++k) {
+        _mm_storeu_ps(glm::value_ptr(out[k][column]), _mm256_castps256_ps128(columns[k]));
+        _mm_storeu_ps(glm::value_ptr(out[k + 4][column]), _mm256_extractf128_ps(columns[k], 1));
+    }
+}
+
+__attribute__((target("avx2")))
+void compose_avx2(const Transform* transforms, glm::mat4* out, std::size_t count) {
+    static_assert(sizeof(Transform) == 10 * sizeof(float), "compose_avx2 gathers Transform as 10 floats");
+    // position xyz, rotation xyzw (glm's default quaternion storage), scale xyz
+    const __m256i stride = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(10));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const auto* base = reinterpret_cast<const float*>(transforms + i);
+        __m256 fields[10];
+        for (int f = 0; f < 10; ++f) {
+            fields[f] = _mm256_i32gather_ps(base, _mm256_add_epi32(stride, _mm256_set1_epi32(f)), 4);
+        }
+        const __m256 qx = fields[3], qy = fields[4], qz = fields[5], qw = fields[6];
+
+        // glm::mat3_cast, term by term
+        const __m256 qxx = _mm256_mul_ps(qx, qx);
+        const __m256 qyy = _mm256_mul_ps(qy, qy);
+        const __m256 qzz = _mm256_mul_ps(qz, qz);
+        const __m256 qxz = _mm256_mul_ps(qx, qz);
+        const __m256 qxy = _mm256_mul_ps(qx, qy);
+        const __m256 qyz = _mm256_mul_ps(qy, qz);
+        const __m256 qwx = _mm256_mul_ps(qw, qx);
+        const __m256 qwy = _mm256_mul_ps(qw, qy);
+        const __m256 qwz = _mm256_mul_ps(qw, qz);
+
+        const __m256 rotation[9] = {
+                _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qyy, qzz))),
+                _mm256_mul_ps(two, _mm256_add_ps(qxy, qwz)),
+                _mm256_mul_ps(two, _mm256_sub_ps(qxz, qwy)),
+                _mm256_mul_ps(two, _mm256_sub_ps(qxy, qwz)),
+                _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qzz))),
+                _mm256_mul_ps(two, _mm256_add_ps(qyz, qwx)),
+                _mm256_mul_ps(two, _mm256_add_ps(qxz, qwy)),
+                _mm256_mul_ps(two, _mm256_sub_ps(qyz, qwx)),
+                _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qyy))),
+        };
+
+        const __m256 zero = _mm256_setzero_ps();
+        for (int c = 0; c < 3; ++c) {
+            store_columns(out + i, c, _mm256_mul_ps(rotation[c * 3], fields[7 + c]),
+                          _mm256_mul_ps(rotation[c * 3 + 1], fields[7 + c]),
+                          _mm256_mul_ps(rotation[c * 3 + 2], fields[7 + c]), zero);
+        }
+        store_columns(out + i, 3, fields[0], fields[1], fields[2], one);
+    }
+    for (; i < count; ++i) {
+        out[i] = to_matrix(transforms[i]);
+    }
+}
+
+#endif
+
+} // namespace
+
+void multiply(const glm::mat4& left, std::span<const glm::mat4> right, std::span<glm::mat4> out) {
+#ifdef TOOLS_X86
+    if (batch_math_avx2()) {
+        multiply_avx2(left, right.data(), out.data(), right.size());
+        return;
+    }
+#endif
+    for (std::size_t i = 0; i < right.size(); ++i) {
+        out[i] = left * right[i];
+    }
+}
+
+void compose(std::span<const Transform> transforms, std::span<glm::mat4> out) {
+#ifdef TOOLS_X86
+    if (batch_math_avx2()) {
+        compose_avx2(transforms.data(), out.data(), transforms.size());
+        return;
+    }
+#endif
+    for (std::size_t i = 0; i < transforms.size(); ++i) {
+        out[i] = to_matrix(transforms[i]);
+    }
+}
+
+void transform_points(const glm::mat4& matrix, std::span<const glm::vec3> points, std::span<glm::vec3> out) {
+#ifdef TOOLS_X86
+    if (batch_math_avx2()) {
+        transform_points_avx2(matrix, points.data(), out.data(), points.size());
+        return;
+    }
+#endif
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        out[i] = glm::vec3(matrix * glm::vec4(points[i], 1.0f));
+    }
+}
+
+void set_batch_math_avx2(bool enabled) {
+    avx2_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool batch_math_avx2() {
+    return has_avx2() && avx2_enabled.load(std::memory_order_relaxed);
+}
+
+} // tools
@@ -0,0 +1,573 @@
+#include "tools/block_compression.h"
+#include "tools/texture.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace tools {
+
+namespace {
+
+/**
+ * Endpoints of the line that best fits the block's pixels (first N channels).
+ * the axis comes from a few power iterations over the covariance matrix.
+ */
+template<int N>
+void principal_endpoints(const std::uint8_t* rgba, float* low, float* high) {
+    float mean[N] = {};
+    for (int p = 0; p < 16; ++p) {
+        for (int c = 0; c < N; ++c) {
+            mean[c] += rgba[p * 4 + c];
+        }
+    }
+    for (int c = 0; c < N; ++c) {
+        mean[c] /= 16.0f;
+    }
+
+    float covariance[N][N] = {};
+    for (int p = 0; p < 16; ++p) {
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j) {
+                covariance[i][j] += (rgba[p * 4 + i] - mean[i]) * (rgba[p * 4 + j] - mean[j]);
+            }
+        }
+    }
+
+    float axis[N];
+    std::fill(axis, axis + N, 1.0f);
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[N] = {};
+        float largest = 0.0f;
+        for (int i = 0; i < N; ++i) {
+            for (int j = 0; j < N; ++j) {
+                next[i] += covariance[i][j] * axis[j];
+            }
+            largest = std::max(largest, std::abs(next[i]));
+        }
+        if (largest == 0.0f) {
+            break;
+        }
+        for (int i = 0; i < N; ++i) {
+            axis[i] = next[i] / largest;
+        }
+    }
+
+    float length = 0.0f;
+    for (int c = 0; c < N; ++c) {
+        length += axis[c] * axis[c];
+    }
+    length = std::sqrt(length);
+    for (int c = 0; c < N; ++c) {
+        axis[c] /= length;
+    }
+
+    float t_min = 0.0f;
+    float t_max = 0.0f;
+    for (int p = 0; p < 16; ++p) {
+        float t = 0.0f;
+        for (int c = 0; c < N; ++c) {
+            t += (rgba[p * 4 + c] - mean[c]) * axis[c];
+        }
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+
+    for (int c = 0; c < N; ++c) {
+        low[c] = std::clamp(mean[c] + axis[c] * t_min, 0.0f, 255.0f);
+        high[c] = std::clamp(mean[c] + axis[c] * t_max, 0.0f, 255.0f);
+    }
+}
+
+std::uint16_t to_565(const float* rgb) {
+    const auto r = static_cast<std::uint16_t>(std::lround(rgb[0] * 31.0f / 255.0f));
+    const auto g = static_cast<std::uint16_t>(std::lround(rgb[1] * 63.0f / 255.0f));
+    const auto b = static_cast<std::uint16_t>(std::lround(rgb[2] * 31.0f / 255.0f));
+    return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void from_565(std::uint16_t colour, int* rgb) {
+    const int r = (colour >> 11) & 31;
+    const int g = (colour >> 5) & 63;
+    const int b = colour & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+template<int N>
+int nearest(const std::uint8_t* pixel, const int (* palette)[4], int palette_size) {
+    int best = 0;
+    int best_error = 1 << 30;
+    for (int i = 0; i < palette_size; ++i) {
+        int error = 0;
+        for (int c = 0; c < N; ++c) {
+            const int d = pixel[c] - palette[i][c];
+            error += d * d;
+        }
+        if (error < best_error) {
+            best_error = error;
+            best = i;
+        }
+    }
+    return best;
+}
+
+void encode_bc3_alpha(const std::uint8_t* rgba, std::uint8_t* out) {
+    int a0 = 0;
+    int a1 = 255;
+    for (int p = 0; p < 16; ++p) {
+        a0 = std::max<int>(a0, rgba[p * 4 + 3]);
+        a1 = std::min<int>(a1, rgba[p * 4 + 3]);
+    }
+    out[0] = static_cast<std::uint8_t>(a0);
+    out[1] = static_cast<std::uint8_t>(a1);
+
+    std::uint64_t bits = 0;
+    if (a0 != a1) {
+        // a0 > a1 selects the 8 level mode: a0, a1, then 6 steps from a0 to a1
+        int palette[8][4] = {};
+        palette[0][0] = a0;
+        palette[1][0] = a1;
+        for (int i = 1; i < 7; ++i) {
+            palette[i + 1][0] = ((7 - i) * a0 + i * a1) / 7;
+        }
+        for (int p = 0; p < 16; ++p) {
+            const std::uint8_t alpha = rgba[p * 4 + 3];
+            const auto index = static_cast<std::uint64_t>(nearest<1>(&alpha, palette, 8));
+            bits |= index << (3 * p);
+        }
+    }
+
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<std::uint8_t>(bits >> (8 * i));
+    }
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::uint8_t* out) : _out(out) {
+        std::memset(_out, 0, 16);
+    }
+
+    void put(unsigned int value, int count) {
+        for (int b = 0; b < count; ++b, ++_position) {
+            if ((value >> b) & 1u) {
+                _out[_position / 8] |= static_cast<std::uint8_t>(1u << (_position % 8));
+            }
+        }
+    }
+
+private:
+    std::uint8_t* _out;
+    int _position = 0;
+};
+
+// 7 bit endpoint + shared p bit, picking whichever p bit lands closer
+void quantize_bc7_endpoint(const float* value, int* endpoint7, int& p_bit) {
+    float best_error = 1e30f;
+    for (int p = 0; p < 2; ++p) {
+        float error = 0.0f;
+        int candidate[4];
+        for (int c = 0; c < 4; ++c) {
+            candidate[c] = std::clamp(static_cast<int>(std::lround((value[c] - static_cast<float>(p)) / 2.0f)), 0, 127);
+            const float d = static_cast<float>((candidate[c] << 1) | p) - value[c];
+            error += d * d;
+        }
+        if (error < best_error) {
+            best_error = error;
+            p_bit = p;
+            std::copy(candidate, candidate + 4, endpoint7);
+        }
+    }
+}
+
+void load_block(const Image& image, int block_x, int block_y, std::uint8_t* block) {
+    for (int y = 0; y < 4; ++y) {
+        const int src_y = std::min(block_y * 4 + y, image.height - 1);
+        for (int x = 0; x < 4; ++x) {
+            const int src_x = std::min(block_x * 4 + x, image.width - 1);
+            const std::uint8_t* src = image.pixels.data() + (static_cast<std::size_t>(src_y) * image.width + src_x) * 4;
+            std::memcpy(block + (y * 4 + x) * 4, src, 4);
+        }
+    }
+}
+
+Image to_rgba(const Image& image) {
+    if (image.channels == 4) {
+        return image;
+    }
+    Image rgba;
+    rgba.width = image.width;
+    rgba.height = image.height;
+    rgba.channels = 4;
+    rgba.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 4);
+    for (std::size_t p = 0; p < static_cast<std::size_t>(image.width) * image.height; ++p) {
+        const std::uint8_t* src = image.pixels.data() + p * image.channels;
+        std::uint8_t* dst = rgba.pixels.data() + p * 4;
+        switch (image.channels) {
+            case 1:
+                dst[0] = dst[1] = dst[2] = src[0];
+                dst[3] = 255;
+                break;
+            case 2:
+                dst[0] = dst[1] = dst[2] = src[0];
+                dst[3] = src[1];
+                break;
+            default:
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                dst[3] = 255;
+                break;
+        }
+    }
+    return rgba;
+}
+
+constexpr std::uint32_t fourcc(char a, char b, char c, char d) {
+    return static_cast<std::uint32_t>(a) | (static_cast<std::uint32_t>(b) << 8) |
+           (static_cast<std::uint32_t>(c) << 16) | (static_cast<std::uint32_t>(d) << 24);
+}
+
+struct DdsPixelFormat {
+    std::uint32_t size;
+    std::uint32_t flags;
+    std::uint32_t four_cc;
+    std::uint32_t rgb_bit_count;
+    std::uint32_t masks[4];
+};
+
+struct DdsHeader {
+    std::uint32_t size;
+    std::uint32_t flags;
+    std::uint32_t height;
+    std::uint32_t width;
+    std::uint32_t pitch_or_linear_size;
+    std::uint32_t depth;
+    std::uint32_t mip_map_count;
+    std::uint32_t reserved1[11];
+    DdsPixelFormat pixel_format;
+    std::uint32_t caps[4];
+    std::uint32_t reserved2;
+};
+
+struct DdsHeaderDx10 {
+    std::uint32_t dxgi_format;
+    std::uint32_t resource_dimension;
+    std::uint32_t misc_flag;
+    std::uint32_t array_size;
+    std::uint32_t misc_flags2;
+};
+
+static_assert(sizeof(DdsHeader) == 124, "DDS header must be 124 bytes");
+
+constexpr std::uint32_t DXGI_BC1_UNORM = 71;
+constexpr std::uint32_t DXGI_BC1_UNORM_SRGB = 72;
+constexpr std::uint32_t DXGI_BC3_UNORM = 77;
+constexpr std::uint32_t DXGI_BC3_UNORM_SRGB = 78;
+constexpr std::uint32_t DXGI_BC7_UNORM = 98;
+constexpr std::uint32_t DXGI_BC7_UNORM_SRGB = 99;
+
+} // namespace
+
+int block_bytes(BlockFormat format) {
+    return format == BlockFormat::bc1 ? 8 : 16;
+}
+
+GLenum compressed_internal_format(BlockFormat format, bool srgb) {
+    switch (format) {
+        case BlockFormat::bc1:
+            return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case BlockFormat::bc3:
+            return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        default:
+            return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+}
+
+bool compressed_format_supported(BlockFormat format) {
+    if (format == BlockFormat::bc7) {
+        return GLAD_GL_VERSION_4_2;
+    }
+
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const auto* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (name && std::strcmp(name, "GL_EXT_texture_compression_s3tc") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void encode_bc1_block(const std::uint8_t* rgba, std::uint8_t* out) {
+    float low[3], high[3];
+    principal_endpoints<3>(rgba, low, high);
+
+    std::uint16_t c0 = to_565(high);
+    std::uint16_t c1 = to_565(low);
+    // c0 > c1 is the 4 colour mode, c0 <= c1 would be 3 colours + transparent black
+    if (c0 < c1) {
+        std::swap(c0, c1);
+    }
+
+    std::uint32_t indices = 0;
+    if (c0 != c1) {
+        int palette[4][4] = {};
+        from_565(c0, palette[0]);
+        from_565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int p = 0; p < 16; ++p) {
+            indices |= static_cast<std::uint32_t>(nearest<3>(rgba + p * 4, palette, 4)) << (2 * p);
+        }
+    }
+
+    out[0] = static_cast<std::uint8_t>(c0 & 0xFF);
+    out[1] = static_cast<std::uint8_t>(c0 >> 8);
+    out[2] = static_cast<std::uint8_t>(c1 & 0xFF);
+    out[3] = static_cast<std::uint8_t>(c1 >> 8);
+    for (int i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<std::uint8_t>(indices >> (8 * i));
+    }
+}
+
+void encode_bc3_block(const std::uint8_t* rgba, std::uint8_t* out) {
+    encode_bc3_alpha(rgba, out);
+    encode_bc1_block(rgba, out + 8);
+}
+
+void encode_bc7_block(const std::uint8_t* rgba, std::uint8_t* out) {
+    // mode 6: one subset, RGBA 7.7.7.7 endpoints with a p bit each, 4 bit indices
+    static constexpr int weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    float low[4], high[4];
+    principal_endpoints<4>(rgba, low, high);
+
+    int endpoint[2][4];
+    int p_bit[2];
+    quantize_bc7_endpoint(low, endpoint[0], p_bit[0]);
+    quantize_bc7_endpoint(high, endpoint[1], p_bit[1]);
+
+    int palette[16][4];
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            const int e0 = (endpoint[0][c] << 1) | p_bit[0];
+            const int e1 = (endpoint[1][c] << 1) | p_bit[1];
+            palette[i][c] = ((64 - weights[i]) * e0 + weights[i] * e1 + 32) >> 6;
+        }
+    }
+
+    int indices[16];
+    for (int p = 0; p < 16; ++p) {
+        indices[p] = nearest<4>(rgba + p * 4, palette, 16);
+    }
+
+    // the first index is stored with 3 bits, so its top bit has to be 0. flip the line if it isn't
+    if (indices[0] & 8) {
+        std::swap(endpoint[0], endpoint[1]);
+        std::swap(p_bit[0], p_bit[1]);
+        for (int& index: indices) {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter writer(out);
+    writer.put(1u << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        writer.put(static_cast<unsigned int>(endpoint[0][c]), 7);
+        writer.put(static_cast<unsigned int>(endpoint[1][c]), 7);
+    }
+    writer.put(static_cast<unsigned int>(p_bit[0]), 1);
+    writer.put(static_cast<unsigned int>(p_bit[1]), 1);
+    writer.put(static_cast<unsigned int>(indices[0]), 3);
+    for (int p = 1; p < 16; ++p) {
+        writer.put(static_cast<unsigned int>(indices[p]), 4);
+    }
+}
+
+CompressedImage compress_image(const Image& image, BlockFormat format, bool srgb, bool mipmaps) {
+    CompressedImage compressed;
+    compressed.format = format;
+    compressed.srgb = srgb;
+    compressed.width = image.width;
+    compressed.height = image.height;
+
+    const int levels = mipmaps ? mip_count(image.width, image.height) : 1;
+    const auto bytes = static_cast<std::size_t>(block_bytes(format));
+
+    Image level = to_rgba(image);
+    for (int l = 0; l < levels; ++l) {
+        const int blocks_x = (level.width + 3) / 4;
+        const int blocks_y = (level.height + 3) / 4;
+        std::vector<std::uint8_t> data(static_cast<std::size_t>(blocks_x) * blocks_y * bytes);
+
+        std::uint8_t block[64];
+        for (int by = 0; by < blocks_y; ++by) {
+            for (int bx = 0; bx < blocks_x; ++bx) {
+                load_block(level, bx, by, block);
+                std::uint8_t* out = data.data() + (static_cast<std::size_t>(by) * blocks_x + bx) * bytes;
+                switch (format) {
+                    case BlockFormat::bc1:
+                        encode_bc1_block(block, out);
+                        break;
+                    case BlockFormat::bc3:
+                        encode_bc3_block(block, out);
+                        break;
+                    case BlockFormat::bc7:
+                        encode_bc7_block(block, out);
+                        break;
+                }
+            }
+        }
+        compressed.levels.push_back(std::move(data));
+
+        if (l + 1 < levels) {
+            level = half_size(level);
+        }
+    }
+    return compressed;
+}
+
+bool write_dds(const std::string& path, const CompressedImage& image) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "ERROR::DDS::FAILED_TO_OPEN: " << path << std::endl;
+        return false;
+    }
+
+    DdsHeader header{};
+    header.size = sizeof(DdsHeader);
+    header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps, height, width, pixel format, mips, linear size
+    header.height = static_cast<std::uint32_t>(image.height);
+    header.width = static_cast<std::uint32_t>(image.width);
+    header.pitch_or_linear_size = image.levels.empty() ? 0 : static_cast<std::uint32_t>(image.levels[0].size());
+    header.mip_map_count = static_cast<std::uint32_t>(image.levels.size());
+    header.pixel_format.size = sizeof(DdsPixelFormat);
+    header.pixel_format.flags = 0x4; // four cc
+    header.caps[0] = 0x1000 | (image.levels.size() > 1 ? 0x400000 | 0x8 : 0); // texture, mipmap, complex
+
+    // the legacy four cc has no sRGB flag, so anything sRGB (and bc7) goes through the dx10 header
+    const bool dx10 = image.srgb || image.format == BlockFormat::bc7;
+    if (dx10) {
+        header.pixel_format.four_cc = fourcc('D', 'X', '1', '0');
+    } else {
+        header.pixel_format.four_cc = image.format == BlockFormat::bc1 ? fourcc('D', 'X', 'T', '1') : fourcc('D', 'X', 'T', '5');
+    }
+
+    const std::uint32_t magic = fourcc('D', 'D', 'S', ' ');
+    file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (dx10) {
+        DdsHeaderDx10 extension{};
+        switch (image.format) {
+            case BlockFormat::bc1:
+                extension.dxgi_format = image.srgb ? DXGI_BC1_UNORM_SRGB : DXGI_BC1_UNORM;
+                break;
+            case BlockFormat::bc3:
+                extension.dxgi_format = image.srgb ? DXGI_BC3_UNORM_SRGB : DXGI_BC3_UNORM;
+                break;
+            case BlockFormat::bc7:
+                extension.dxgi_format = image.srgb ? DXGI_BC7_UNORM_SRGB : DXGI_BC7_UNORM;
+                break;
+        }
+        extension.resource_dimension = 3; // texture 2d
+        extension.array_size = 1;
+        file.write(reinterpret_cast<const char*>(&extension), sizeof(extension));
+    }
+
+    for (const auto& level: image.levels) {
+        file.write(reinterpret_cast<const char*>(level.data()), static_cast<std::streamsize>(level.size()));
+    }
+    return static_cast<bool>(file);
+}
+
+bool load_dds(const std::string& path, CompressedImage& out, int first_level) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "ERROR::DDS::FAILED_TO_OPEN: " << path << std::endl;
+        return false;
+    }
+
+    std::uint32_t magic = 0;
+    DdsHeader header{};
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || magic != fourcc('D', 'D', 'S', ' ') || header.size != sizeof(DdsHeader)) {
+        std::cerr << "ERROR::DDS::INVALID_HEADER: " << path << std::endl;
+        return false;
+    }
+
+    out.srgb = false;
+    const std::uint32_t four_cc = header.pixel_format.four_cc;
+    if (four_cc == fourcc('D', 'X', 'T', '1')) {
+        out.format = BlockFormat::bc1;
+    } else if (four_cc == fourcc('D', 'X', 'T', '5')) {
+        out.format = BlockFormat::bc3;
+    } else if (four_cc == fourcc('D', 'X', '1', '0')) {
+        DdsHeaderDx10 extension{};
+        file.read(reinterpret_cast<char*>(&extension), sizeof(extension));
+        switch (extension.dxgi_format) {
+            case DXGI_BC1_UNORM_SRGB:
+                out.srgb = true;
+                [[fallthrough]];
+            case DXGI_BC1_UNORM:
+                out.format = BlockFormat::bc1;
+                break;
+            case DXGI_BC3_UNORM_SRGB:
+                out.srgb = true;
+                [[fallthrough]];
+            case DXGI_BC3_UNORM:
+                out.format = BlockFormat::bc3;
+                break;
+            case DXGI_BC7_UNORM_SRGB:
+                out.srgb = true;
+                [[fallthrough]];
+            case DXGI_BC7_UNORM:
+                out.format = BlockFormat::bc7;
+                break;
+            default:
+                std::cerr << "ERROR::DDS::UNSUPPORTED_FORMAT: " << path << std::endl;
+                return false;
+        }
+    } else {
+        std::cerr << "ERROR::DDS::UNSUPPORTED_FORMAT: " << path << std::endl;
+        return false;
+    }
+
+    out.width = static_cast<int>(header.width);
+    out.height = static_cast<int>(header.height);
+    const int levels = std::max(1, static_cast<int>(header.mip_map_count));
+    const auto bytes = static_cast<std::size_t>(block_bytes(out.format));
+    out.level_count = levels;
+
+    out.levels.clear();
+    int width = out.width;
+    int height = out.height;
+    for (int l = 0; l < levels; ++l) {
+        const std::size_t size = static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * bytes;
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+        if (l < first_level) {
+            file.seekg(static_cast<std::streamoff>(size), std::ios::cur);
+            continue;
+        }
+
+        std::vector<std::uint8_t> level(size);
+        file.read(reinterpret_cast<char*>(level.data()), static_cast<std::streamsize>(level.size()));
+        if (!file) {
+            std::cerr << "ERROR::DDS::TRUNCATED: " << path << std::endl;
+            return false;
+        }
+        out.levels.push_back(std::move(level));
+    }
+    return true;
+}
+
+} // tools
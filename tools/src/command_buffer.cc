@@ -0,0 +1,23 @@
+#include "tools/command_buffer.h"
+
+namespace tools {
+
+void CommandBuffer::execute() const {
+    for (const auto& command: _commands) {
+        command();
+    }
+}
+
+void CommandBuffer::clear() {
+    _commands.clear();
+}
+
+std::size_t CommandBuffer::size() const {
+    return _commands.size();
+}
+
+bool CommandBuffer::empty() const {
+    return _commands.empty();
+}
+
+} // tools
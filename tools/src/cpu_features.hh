@@ -0,0 +1,21 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TOOLS_X86 1
+#endif
+
+// runtime ISA checks for the kernels compiled with __attribute__((target(...))), so the library itself
+// doesn't need -mavx2 and still runs on older CPUs
+namespace tools {
+
+inline bool has_avx2() {
+#ifdef TOOLS_X86
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+} // tools
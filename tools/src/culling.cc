@@ -0,0 +1,315 @@
+#include "tools/culling.h"
+#include "tools/job_system.h"
+#include "cpu_features.hh"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace tools {
+
+namespace {
+
+// padding entries: nothing can be this far inside a plane, so they always fail
+constexpr float never_visible = -1e30f;
+
+std::size_t padded(std::size_t size) {
+    return (size + 7) & ~std::size_t(7);
+}
+
+void set_padded(std::vector<float>& values, std::size_t index, float value, float padding) {
+    if (index >= values.size()) {
+        values.resize(padded(index + 1), padding);
+    }
+    values[index] = value;
+}
+
+Plane normalized(float a, float b, float c, float d) {
+    const float length = std::sqrt(a * a + b * b + c * c);
+    return {glm::vec3(a / length, b / length, c / length), d / length};
+}
+
+std::size_t cull_range_scalar(const Frustum& frustum, const BoundingSpheres& spheres, std::size_t first,
+                              std::size_t last, std::uint32_t* out) {
+    std::size_t count = 0;
+    last = std::min(last, spheres.size());
+    for (std::size_t i = first; i < last; ++i) {
+        bool inside = true;
+        for (const Plane& plane: frustum.planes) {
+            const float distance = plane.normal.x * spheres.x()[i] + plane.normal.y * spheres.y()[i] +
+                                   plane.normal.z * spheres.z()[i] + plane.distance;
+            inside = inside && distance >= -spheres.radius()[i];
+        }
+        out[count] = static_cast<std::uint32_t>(i);
+        count += inside; // store unconditionally, no branch to mispredict
+    }
+    return count;
+}
+
+std::size_t cull_range_scalar(const Frustum& frustum, const BoundingBoxes& boxes, std::size_t first,
+                              std::size_t last, std::uint32_t* out) {
+    std::size_t count = 0;
+    last = std::min(last, boxes.size());
+    for (std::size_t i = first; i < last; ++i) {
+        bool inside = true;
+        for (const Plane& plane: frustum.planes) {
+            // the centre's distance plus how far the box reaches towards the plane normal
+            float distance = plane.distance;
+            for (int axis = 0; axis < 3; ++axis) {
+                distance += plane.normal[axis] * boxes.centre(axis)[i] +
+                            std::abs(plane.normal[axis]) * boxes.extent(axis)[i];
+            }
+            inside = inside && distance >= 0.0f;
+        }
+        out[count] = static_cast<std::uint32_t>(i);
+        count += inside;
+    }
+    return count;
+}
+
+#ifdef TOOLS_X86
+
+// for every 8 bit visibility mask, the lanes to pack to the front
+const std::array<std::array<std::uint32_t, 8>, 256> compaction_table = [] {
+    std::array<std::array<std::uint32_t, 8>, 256> table{};
+    for (unsigned int mask = 0; mask < 256; ++mask) {
+        unsigned int lane = 0;
+        for (unsigned int bit = 0; bit < 8; ++bit) {
+            if (mask & (1u << bit)) {
+                table[mask][lane++] = bit;
+            }
+        }
+    }
+    return table;
+}();
+
+/**
+ * appends the indices of the visible lanes to out. always stores all 8 lanes, the ones past the count are junk
+ */
+__attribute__((target("avx2,fma")))
+inline std::size_t store_visible(__m256 visible, std::size_t base, std::uint32_t* out) {
+    const int mask = _mm256_movemask_ps(visible);
+    const __m256i indices = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(base)),
+                                             _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(compaction_table[mask].data()));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permutevar8x32_epi32(indices, lanes));
+    return static_cast<std::size_t>(std::popcount(static_cast<unsigned int>(mask)));
+}
+
+__attribute__((target("avx2,fma")))
+std::size_t cull_range_avx2(const Frustum& frustum, const BoundingSpheres& spheres, std::size_t first,
+                            std::size_t last, std::uint32_t* out) {
+    __m256 normal_x[6], normal_y[6], normal_z[6], distance[6];
+    for (int p = 0; p < 6; ++p) {
+        normal_x[p] = _mm256_set1_ps(frustum.planes[p].normal.x);
+        normal_y[p] = _mm256_set1_ps(frustum.planes[p].normal.y);
+        normal_z[p] = _mm256_set1_ps(frustum.planes[p].normal.z);
+        distance[p] = _mm256_set1_ps(frustum.planes[p].distance);
+    }
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+
+    std::size_t count = 0;
+    for (std::size_t i = first; i < last; i += 8) {
+        const __m256 x = _mm256_loadu_ps(spheres.x() + i);
+        const __m256 y = _mm256_loadu_ps(spheres.y() + i);
+        const __m256 z = _mm256_loadu_ps(spheres.z() + i);
+        const __m256 negative_radius = _mm256_xor_ps(_mm256_loadu_ps(spheres.radius() + i), sign);
+
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            const __m256 d = _mm256_fmadd_ps(normal_x[p], x, _mm256_fmadd_ps(normal_y[p], y,
+                                                                             _mm256_fmadd_ps(normal_z[p], z,
+                                                                                             distance[p])));
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(d, negative_radius, _CMP_GE_OQ));
+        }
+        count += store_visible(visible, i, out + count);
+    }
+    return count;
+}
+
+__attribute__((target("avx2,fma")))
+std::size_t cull_range_avx2(const Frustum& frustum, const BoundingBoxes& boxes, std::size_t first,
+                            std::size_t last, std::uint32_t* out) {
+    __m256 normal[6][3], absolute[6][3], distance[6];
+    for (int p = 0; p < 6; ++p) {
+        for (int axis = 0; axis < 3; ++axis) {
+            normal[p][axis] = _mm256_set1_ps(frustum.planes[p].normal[axis]);
+            absolute[p][axis] = _mm256_set1_ps(std::abs(frustum.planes[p].normal[axis]));
+        }
+        distance[p] = _mm256_set1_ps(frustum.planes[p].distance);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+
+    std::size_t count = 0;
+    for (std::size_t i = first; i < last; i += 8) {
+        __m256 centre[3], extent[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            centre[axis] = _mm256_loadu_ps(boxes.centre(axis) + i);
+            extent[axis] = _mm256_loadu_ps(boxes.extent(axis) + i);
+        }
+
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; ++p) {
+            __m256 d = distance[p];
+            for (int axis = 0; axis < 3; ++axis) {
+                d = _mm256_fmadd_ps(normal[p][axis], centre[axis], d);
+                d = _mm256_fmadd_ps(absolute[p][axis], extent[axis], d);
+            }
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(d, zero, _CMP_GE_OQ));
+        }
+        count += store_visible(visible, i, out + count);
+    }
+    return count;
+}
+
+#endif
+
+template<typename Volumes>
+std::size_t cull_range(const Frustum& frustum, const Volumes& volumes, std::size_t first, std::size_t last,
+                       std::uint32_t* out) {
+#ifdef TOOLS_X86
+    if (has_avx2()) {
+        return cull_range_avx2(frustum, volumes, first, last, out);
+    }
+#endif
+    return cull_range_scalar(frustum, volumes, first, last, out);
+}
+
+template<typename Volumes>
+std::size_t cull_all(const Frustum& frustum, const Volumes& volumes, std::vector<std::uint32_t>& visible,
+                     unsigned int thread_count) {
+    const std::size_t total = padded(volumes.size());
+    // every chunk writes into its own part of the output. a chunk never gets ahead of its input,
+    // so the 8 lane stores stay inside the chunk too
+    visible.resize(total);
+
+    const std::size_t blocks = total / 8;
+    thread_count = static_cast<unsigned int>(std::clamp<std::size_t>(thread_count, 1, std::max<std::size_t>(blocks, 1)));
+    if (thread_count == 1) {
+        visible.resize(cull_range(frustum, volumes, 0, total, visible.data()));
+        return visible.size();
+    }
+
+    std::vector<std::size_t> firsts(thread_count + 1);
+    std::vector<std::size_t> counts(thread_count);
+    for (unsigned int t = 0; t <= thread_count; ++t) {
+        firsts[t] = blocks * t / thread_count * 8;
+    }
+
+    JobSystem::shared().parallel_for(0, thread_count, 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t t = first; t < last; ++t) {
+            counts[t] = cull_range(frustum, volumes, firsts[t], firsts[t + 1], visible.data() + firsts[t]);
+        }
+    });
+
+    // close the gaps between the chunks, they are in order so this is a forward move
+    std::size_t count = counts[0];
+    for (unsigned int t = 1; t < thread_count; ++t) {
+        std::memmove(visible.data() + count, visible.data() + firsts[t], counts[t] * sizeof(std::uint32_t));
+        count += counts[t];
+    }
+    visible.resize(count);
+    return count;
+}
+
+} // namespace
+
+Frustum extract_frustum(const glm::mat4& view_projection) {
+    // glm is column major, row i is m[0][i], m[1][i], m[2][i], m[3][i]
+    const glm::mat4& m = view_projection;
+    Frustum frustum{};
+    for (int i = 0; i < 3; ++i) {
+        frustum.planes[i * 2] = normalized(m[0][3] + m[0][i], m[1][3] + m[1][i], m[2][3] + m[2][i],
+                                           m[3][3] + m[3][i]);
+        frustum.planes[i * 2 + 1] = normalized(m[0][3] - m[0][i], m[1][3] - m[1][i], m[2][3] - m[2][i],
+                                               m[3][3] - m[3][i]);
+    }
+    return frustum;
+}
+
+std::uint32_t BoundingSpheres::add(const glm::vec3& centre, float radius) {
+    const auto index = static_cast<std::uint32_t>(_size++);
+    set(index, centre, radius);
+    return index;
+}
+
+void BoundingSpheres::set(std::uint32_t index, const glm::vec3& centre, float radius) {
+    set_padded(_x, index, centre.x, 0.0f);
+    set_padded(_y, index, centre.y, 0.0f);
+    set_padded(_z, index, centre.z, 0.0f);
+    set_padded(_radius, index, radius, never_visible);
+}
+
+void BoundingSpheres::clear() {
+    _size = 0;
+    _x.clear();
+    _y.clear();
+    _z.clear();
+    _radius.clear();
+}
+
+std::size_t BoundingSpheres::size() const {
+    return _size;
+}
+
+const float* BoundingSpheres::x() const {
+    return _x.data();
+}
+
+const float* BoundingSpheres::y() const {
+    return _y.data();
+}
+
+const float* BoundingSpheres::z() const {
+    return _z.data();
+}
+
+const float* BoundingSpheres::radius() const {
+    return _radius.data();
+}
+
+std::uint32_t BoundingBoxes::add(const glm::vec3& min, const glm::vec3& max) {
+    const auto index = static_cast<std::uint32_t>(_size++);
+    set(index, min, max);
+    return index;
+}
+
+void BoundingBoxes::set(std::uint32_t index, const glm::vec3& min, const glm::vec3& max) {
+    for (int axis = 0; axis < 3; ++axis) {
+        set_padded(_centre[axis], index, (min[axis] + max[axis]) * 0.5f, 0.0f);
+        set_padded(_extent[axis], index, (max[axis] - min[axis]) * 0.5f, never_visible);
+    }
+}
+
+void BoundingBoxes::clear() {
+    _size = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        _centre[axis].clear();
+        _extent[axis].clear();
+    }
+}
+
+std::size_t BoundingBoxes::size() const {
+    return _size;
+}
+
+const float* BoundingBoxes::centre(int axis) const {
+    return _centre[axis].data();
+}
+
+const float* BoundingBoxes::extent(int axis) const {
+    return _extent[axis].data();
+}
+
+std::size_t cull(const Frustum& frustum, const BoundingSpheres& spheres, std::vector<std::uint32_t>& visible,
+                 unsigned int thread_count) {
+    return cull_all(frustum, spheres, visible, thread_count);
+}
+
+std::size_t cull(const Frustum& frustum, const BoundingBoxes& boxes, std::vector<std::uint32_t>& visible,
+                 unsigned int thread_count) {
+    return cull_all(frustum, boxes, visible, thread_count);
+}
+
+} // tools
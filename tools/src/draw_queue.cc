@@ -0,0 +1,127 @@
+#include "tools/draw_queue.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+namespace tools {
+
+DrawQueue::DrawQueue(std::size_t record_size, GLuint storage_binding, GLuint draw_id_location)
+        : _record_size(record_size), _storage_binding(storage_binding), _draw_id_location(draw_id_location) {
+    _supported = GLAD_GL_VERSION_4_3;
+    if (!_supported) {
+        std::cerr << "ERROR::DRAW_QUEUE::NEEDS_GL_4_3" << std::endl;
+        return;
+    }
+    glGenBuffers(1, &_indirect_buffer);
+    glGenBuffers(1, &_storage_buffer);
+    glGenBuffers(1, &_draw_id_buffer);
+}
+
+DrawQueue::~DrawQueue() {
+    if (_supported) {
+        glDeleteBuffers(1, &_indirect_buffer);
+        glDeleteBuffers(1, &_storage_buffer);
+        glDeleteBuffers(1, &_draw_id_buffer);
+    }
+}
+
+void DrawQueue::submit(const GeometryPool& pool, int handle, const void* records, std::uint32_t instance_count) {
+    const MeshAllocation& allocation = pool.allocation(handle);
+    if (allocation.index_count == 0 || instance_count == 0) {
+        return;
+    }
+
+    const DrawElementsIndirectCommand command{allocation.index_count, instance_count, allocation.first_index,
+                                              static_cast<std::int32_t>(allocation.base_vertex), _record_count};
+    _pending.push_back({&pool, command});
+
+    const auto* bytes = static_cast<const std::uint8_t*>(records);
+    _records.insert(_records.end(), bytes, bytes + _record_size * instance_count);
+    _record_count += instance_count;
+}
+
+int DrawQueue::flush() {
+    if (!_supported || _pending.empty()) {
+        clear();
+        return 0;
+    }
+
+    // base_instance already points at each draw's records, so reordering the commands is free
+    std::stable_sort(_pending.begin(), _pending.end(), [](const Pending& a, const Pending& b) {
+        return a.pool < b.pool;
+    });
+    _commands.clear();
+    for (const Pending& pending: _pending) {
+        _commands.push_back(pending.command);
+    }
+
+    if (_record_count > _draw_id_capacity) {
+        _draw_id_capacity = std::max<std::size_t>(_record_count, _draw_id_capacity * 2);
+        std::vector<std::uint32_t> ids(_draw_id_capacity);
+        std::iota(ids.begin(), ids.end(), 0u);
+        glBindBuffer(GL_ARRAY_BUFFER, _draw_id_buffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(ids.size() * sizeof(std::uint32_t)), ids.data(),
+                     GL_STATIC_DRAW);
+    }
+
+    upload(_storage_buffer, GL_SHADER_STORAGE_BUFFER, _storage_capacity, _records.data(), _records.size());
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, _storage_binding, _storage_buffer, 0,
+                      static_cast<GLsizeiptr>(_records.size()));
+    upload(_indirect_buffer, GL_DRAW_INDIRECT_BUFFER, _indirect_capacity, _commands.data(),
+           _commands.size() * sizeof(DrawElementsIndirectCommand));
+
+    int draw_calls = 0;
+    std::size_t first = 0;
+    while (first < _pending.size()) {
+        const GeometryPool* pool = _pending[first].pool;
+        std::size_t last = first;
+        while (last < _pending.size() && _pending[last].pool == pool) {
+            ++last;
+        }
+
+        pool->bind();
+        // the draw id attribute lives in the pool's VAO, setting it again is a few cheap calls per pool
+        glBindBuffer(GL_ARRAY_BUFFER, _draw_id_buffer);
+        glVertexAttribIPointer(_draw_id_location, 1, GL_UNSIGNED_INT, sizeof(std::uint32_t), nullptr);
+        glVertexAttribDivisor(_draw_id_location, 1);
+        glEnableVertexAttribArray(_draw_id_location);
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, pool->index_type(),
+                                    (void*) (first * sizeof(DrawElementsIndirectCommand)),
+                                    static_cast<GLsizei>(last - first), 0);
+        ++draw_calls;
+        first = last;
+    }
+    glBindVertexArray(0);
+
+    clear();
+    return draw_calls;
+}
+
+void DrawQueue::clear() {
+    _pending.clear();
+    _records.clear();
+    _record_count = 0;
+}
+
+std::size_t DrawQueue::draw_count() const {
+    return _pending.size();
+}
+
+bool DrawQueue::supported() const {
+    return _supported;
+}
+
+void DrawQueue::upload(unsigned int buffer, GLenum target, std::size_t& capacity, const void* data,
+                       std::size_t bytes) {
+    glBindBuffer(target, buffer);
+    if (bytes > capacity) {
+        capacity = std::max(bytes, capacity * 2);
+    }
+    // orphan the old storage so we don't wait on last frame's draws still reading it
+    glBufferData(target, static_cast<GLsizeiptr>(capacity), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(target, 0, static_cast<GLsizeiptr>(bytes), data);
+}
+
+} // tools
@@ -0,0 +1,118 @@
+#include "tools/frame_capture.h"
+#include <cstring>
+
+namespace tools {
+
+FrameCapture::FrameCapture(int width, int height, int ring_size)
+        : _width(width), _height(height), _slots(static_cast<std::size_t>(ring_size)) {
+    const auto size = static_cast<GLsizeiptr>(width) * height * 4;
+    for (Slot& slot: _slots) {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+FrameCapture::~FrameCapture() {
+    for (Slot& slot: _slots) {
+        if (slot.fence != nullptr) {
+            glDeleteSync(slot.fence);
+        }
+        glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+bool FrameCapture::request(unsigned int framebuffer) {
+    if (_pending == _slots.size()) {
+        return false;
+    }
+    Slot& slot = _slots[(_oldest + _pending) % _slots.size()];
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glReadBuffer(framebuffer == 0 ? GL_BACK : GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    // rows are 4 byte multiples with RGBA8, the default pack alignment of 4 is fine
+    glReadPixels(0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // makes sure the fence actually reaches the GPU, or a later wait on it could never return
+    glFlush();
+    ++_pending;
+    return true;
+}
+
+bool FrameCapture::poll(Image& out) {
+    if (_pending == 0) {
+        return false;
+    }
+    Slot& slot = _slots[_oldest];
+    const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        return false;
+    }
+    collect(slot, out);
+    return true;
+}
+
+bool FrameCapture::wait(Image& out) {
+    if (_pending == 0) {
+        return false;
+    }
+    Slot& slot = _slots[_oldest];
+    GLenum status;
+    do {
+        status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+    } while (status == GL_TIMEOUT_EXPIRED);
+    collect(slot, out);
+    return true;
+}
+
+std::size_t FrameCapture::pending() const {
+    return _pending;
+}
+
+int FrameCapture::width() const {
+    return _width;
+}
+
+int FrameCapture::height() const {
+    return _height;
+}
+
+void FrameCapture::collect(Slot& slot, Image& out) {
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    const std::size_t stride = static_cast<std::size_t>(_width) * 4;
+    out.width = _width;
+    out.height = _height;
+    out.channels = 4;
+    out.pixels.resize(stride * _height);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const auto* mapped = static_cast<const unsigned char*>(
+            glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(stride * _height), GL_MAP_READ_BIT));
+    if (mapped != nullptr) {
+        // GL's first row is the bottom one
+        for (int y = 0; y < _height; ++y) {
+            std::memcpy(&out.pixels[y * stride], mapped + (_height - 1 - y) * stride, stride);
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    _oldest = (_oldest + 1) % _slots.size();
+    --_pending;
+}
+
+Image capture_framebuffer(unsigned int framebuffer, int width, int height) {
+    FrameCapture capture(width, height, 1);
+    capture.request(framebuffer);
+    Image image;
+    capture.wait(image);
+    return image;
+}
+
+} // tools
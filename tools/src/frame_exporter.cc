@@ -0,0 +1,140 @@
+#include "tools/frame_exporter.h"
+#include "tools/png.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace tools {
+
+FrameExporter::FrameExporter(const ExportDesc& desc, JobSystem& jobs) : _desc(desc), _job_system(jobs) {
+    if (!_desc.pipe_command.empty()) {
+        _pipe = popen(_desc.pipe_command.c_str(), "w");
+        if (_pipe == nullptr) {
+            std::cerr << "ERROR::FRAME_EXPORTER::FAILED_TO_OPEN_PIPE: " << _desc.pipe_command << std::endl;
+            _failed = true;
+        }
+    }
+}
+
+FrameExporter::~FrameExporter() {
+    finish();
+}
+
+void FrameExporter::submit(Image frame) {
+    {
+        // only until one slot is free, not the whole queue. helping with the jobs makes it work with a
+        // JobSystem without workers too, with nothing queued the in flight frames are running elsewhere
+        const std::size_t max_in_flight = std::max<std::size_t>(1, _desc.max_queued_frames);
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (_in_flight >= max_in_flight) {
+            lock.unlock();
+            const bool ran = _job_system.run_one();
+            lock.lock();
+            if (!ran) {
+                _slot_freed.wait(lock, [this, max_in_flight] { return _in_flight < max_in_flight; });
+            }
+        }
+        ++_in_flight;
+    }
+
+    const std::uint64_t index = _next_index++;
+    _job_system.run(_encodes, [this, index, frame = std::move(frame)]() mutable {
+        encode(index, std::move(frame));
+    });
+}
+
+void FrameExporter::finish() {
+    if (_finished) {
+        return;
+    }
+    _finished = true;
+    _job_system.wait(_encodes);
+
+    if (_pipe != nullptr && pclose(_pipe) != 0) {
+        std::cerr << "ERROR::FRAME_EXPORTER::PIPE_COMMAND_FAILED: " << _desc.pipe_command << std::endl;
+        std::lock_guard<std::mutex> lock(_mutex);
+        _failed = true;
+    }
+    _pipe = nullptr;
+}
+
+bool FrameExporter::ok() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return !_failed;
+}
+
+std::uint64_t FrameExporter::frames_written() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _written;
+}
+
+void FrameExporter::encode(std::uint64_t index, Image frame) {
+    std::vector<std::uint8_t> bytes = _desc.format == ExportFormat::png ? encode_png(frame)
+                                                                        : std::move(frame.pixels);
+    if (_desc.pipe_command.empty()) {
+        write_file(index, bytes);
+    } else {
+        write_pipe(index, std::move(bytes));
+    }
+}
+
+void FrameExporter::write_file(std::uint64_t index, const std::vector<std::uint8_t>& bytes) {
+    char number[32];
+    std::snprintf(number, sizeof(number), "%06llu", static_cast<unsigned long long>(index));
+    const std::string path = _desc.directory + "/" + _desc.prefix + number +
+                             (_desc.format == ExportFormat::png ? ".png" : ".rgba");
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!file) {
+        std::cerr << "ERROR::FRAME_EXPORTER::FAILED_TO_WRITE: " << path << std::endl;
+    }
+    done(static_cast<bool>(file));
+}
+
+void FrameExporter::write_pipe(std::uint64_t index, std::vector<std::uint8_t> bytes) {
+    // the pipe has its own mutex so a slow reader on the other end doesn't hold up submit()
+    std::unique_lock<std::mutex> lock(_pipe_mutex);
+    _encoded.emplace(index, std::move(bytes));
+    if (_writing) {
+        return; // the job writing now gets to this one when it's next
+    }
+    _writing = true;
+    while (true) {
+        const auto next = _encoded.find(_next_to_write);
+        if (next == _encoded.end()) {
+            _writing = false;
+            return;
+        }
+        const std::vector<std::uint8_t> data = std::move(next->second);
+        _encoded.erase(next);
+
+        // writing outside the lock, frames finishing meanwhile only get queued
+        lock.unlock();
+        const bool written = _pipe != nullptr && std::fwrite(data.data(), 1, data.size(), _pipe) == data.size();
+        if (!written && _pipe != nullptr) {
+            std::lock_guard<std::mutex> state(_mutex);
+            if (!_failed) {
+                std::cerr << "ERROR::FRAME_EXPORTER::FAILED_TO_WRITE_PIPE" << std::endl;
+            }
+        }
+        done(written);
+        lock.lock();
+        ++_next_to_write;
+    }
+}
+
+void FrameExporter::done(bool written) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_in_flight;
+        if (written) {
+            ++_written;
+        } else {
+            _failed = true;
+        }
+    }
+    _slot_freed.notify_one();
+}
+
+} // tools
@@ -0,0 +1,326 @@
+#include "tools/geometry_pool.h"
+#include <algorithm>
+#include <iostream>
+
+namespace tools {
+
+RangeAllocator::RangeAllocator(std::size_t capacity) : _capacity(capacity) {
+    if (capacity > 0) {
+        insert_free(0, capacity);
+    }
+}
+
+bool RangeAllocator::allocate(std::size_t size, std::size_t& offset) {
+    if (size == 0) {
+        offset = 0;
+        return true;
+    }
+
+    // the smallest block that fits, keeps the big ones intact for big meshes
+    const auto fit = _by_size.lower_bound(size);
+    if (fit == _by_size.end()) {
+        return false;
+    }
+
+    const std::size_t block_size = fit->first;
+    offset = fit->second;
+    erase_free(_by_offset.find(offset));
+    if (block_size > size) {
+        insert_free(offset + size, block_size - size);
+    }
+    _used += size;
+    return true;
+}
+
+void RangeAllocator::free(std::size_t offset, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    _used -= size;
+
+    auto next = _by_offset.lower_bound(offset);
+    if (next != _by_offset.end() && offset + size == next->first) {
+        size += next->second;
+        erase_free(next);
+    }
+
+    next = _by_offset.lower_bound(offset);
+    if (next != _by_offset.begin()) {
+        const auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            erase_free(previous);
+        }
+    }
+    insert_free(offset, size);
+}
+
+void RangeAllocator::grow(std::size_t new_capacity) {
+    if (new_capacity <= _capacity) {
+        return;
+    }
+    const std::size_t old_capacity = _capacity;
+    _capacity = new_capacity;
+    _used += new_capacity - old_capacity; // free() takes it back off
+    free(old_capacity, new_capacity - old_capacity);
+}
+
+std::size_t RangeAllocator::capacity() const {
+    return _capacity;
+}
+
+std::size_t RangeAllocator::used() const {
+    return _used;
+}
+
+void RangeAllocator::insert_free(std::size_t offset, std::size_t size) {
+    _by_offset.emplace(offset, size);
+    _by_size.emplace(size, offset);
+}
+
+void RangeAllocator::erase_free(std::map<std::size_t, std::size_t>::iterator block) {
+    const auto [first, last] = _by_size.equal_range(block->second);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == block->first) {
+            _by_size.erase(it);
+            break;
+        }
+    }
+    _by_offset.erase(block);
+}
+
+GeometryPool::GeometryPool(const VertexLayout& layout, std::size_t vertex_capacity, std::size_t index_capacity,
+                           GLenum index_type)
+        : _layout(layout), _index_type(index_type), _vertices(vertex_capacity), _indices(index_capacity) {
+    glGenVertexArrays(1, &_vao);
+    glGenBuffers(1, &_vbo);
+    glGenBuffers(1, &_ebo);
+
+    glBindVertexArray(_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertex_capacity * static_cast<std::size_t>(_layout.stride())),
+                 nullptr, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(index_capacity * index_size()), nullptr,
+                 GL_STATIC_DRAW);
+
+    _layout.apply();
+
+    glBindVertexArray(0);
+}
+
+GeometryPool::~GeometryPool() {
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteBuffers(1, &_vbo);
+    glDeleteBuffers(1, &_ebo);
+}
+
+int GeometryPool::add(const void* vertices, std::size_t vertex_count, const std::uint32_t* indices,
+                      std::size_t index_count) {
+    if (_index_type == GL_UNSIGNED_SHORT && vertex_count > 65536) {
+        std::cerr << "ERROR::GEOMETRY_POOL::MESH_TOO_BIG_FOR_16BIT_INDICES" << std::endl;
+        return -1;
+    }
+    if (!indices_in_range(indices, index_count, vertex_count)) {
+        return -1;
+    }
+
+    ensure_capacity(vertex_count, index_count);
+
+    std::size_t vertex_offset = 0;
+    _vertices.allocate(vertex_count, vertex_offset);
+
+    const auto stride = static_cast<std::size_t>(_layout.stride());
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(vertex_offset * stride),
+                    static_cast<GLsizeiptr>(vertex_count * stride), vertices);
+
+    const std::size_t index_offset = upload_indices(indices, index_count);
+
+    return make_handle({static_cast<std::uint32_t>(vertex_offset), static_cast<std::uint32_t>(vertex_count),
+                        static_cast<std::uint32_t>(index_offset), static_cast<std::uint32_t>(index_count)}, true);
+}
+
+int GeometryPool::add(const Mesh& mesh) {
+    if (_layout == vertex_layout(VertexFormat::compact)) {
+        const std::vector<CompactVertex> compact = quantize_vertices(mesh.vertices);
+        return add(compact.data(), compact.size(), mesh.indices.data(), mesh.indices.size());
+    }
+    if (_layout.stride() != static_cast<GLsizei>(sizeof(Vertex))) {
+        std::cerr << "ERROR::GEOMETRY_POOL::LAYOUT_DOES_NOT_MATCH_MESH" << std::endl;
+        return -1;
+    }
+    return add(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size());
+}
+
+int GeometryPool::add_indices(int handle, const std::uint32_t* indices, std::size_t index_count) {
+    if (!valid(handle)) {
+        std::cerr << "ERROR::GEOMETRY_POOL::INVALID_HANDLE: " << handle << std::endl;
+        return -1;
+    }
+    const MeshAllocation vertices = _allocations[static_cast<std::size_t>(handle)];
+    if (!indices_in_range(indices, index_count, vertices.vertex_count)) {
+        return -1;
+    }
+    ensure_capacity(0, index_count);
+    const std::size_t index_offset = upload_indices(indices, index_count);
+    return make_handle({vertices.base_vertex, vertices.vertex_count, static_cast<std::uint32_t>(index_offset),
+                        static_cast<std::uint32_t>(index_count)}, false);
+}
+
+bool GeometryPool::indices_in_range(const std::uint32_t* indices, std::size_t index_count, std::size_t vertex_count) {
+    // past the mesh's vertices they'd read another mesh's, and a 16 bit pool would truncate them on upload
+    for (std::size_t i = 0; i < index_count; ++i) {
+        if (indices[i] >= vertex_count) {
+            std::cerr << "ERROR::GEOMETRY_POOL::INDEX_OUT_OF_RANGE: " << indices[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void GeometryPool::remove(int handle) {
+    if (!valid(handle)) {
+        return;
+    }
+    const auto index = static_cast<std::size_t>(handle);
+    const MeshAllocation& allocation = _allocations[index];
+    if (_owns_vertices[index]) {
+        _vertices.free(allocation.base_vertex, allocation.vertex_count);
+    }
+    _indices.free(allocation.first_index, allocation.index_count);
+    _live[index] = false;
+    _free_handles.push_back(handle);
+}
+
+bool GeometryPool::valid(int handle) const {
+    return handle >= 0 && static_cast<std::size_t>(handle) < _live.size() && _live[static_cast<std::size_t>(handle)];
+}
+
+const MeshAllocation& GeometryPool::allocation(int handle) const {
+    return _allocations[static_cast<std::size_t>(handle)];
+}
+
+void GeometryPool::bind() const {
+    glBindVertexArray(_vao);
+}
+
+void GeometryPool::draw(int handle, GLsizei instance_count) const {
+    const MeshAllocation& allocation = _allocations[static_cast<std::size_t>(handle)];
+    const auto count = static_cast<GLsizei>(allocation.index_count);
+    auto* offset = (void*) (allocation.first_index * index_size());
+    const auto base_vertex = static_cast<GLint>(allocation.base_vertex);
+
+    if (instance_count == 1) {
+        glDrawElementsBaseVertex(GL_TRIANGLES, count, _index_type, offset, base_vertex);
+    } else {
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, count, _index_type, offset, instance_count, base_vertex);
+    }
+}
+
+const VertexLayout& GeometryPool::layout() const {
+    return _layout;
+}
+
+GLenum GeometryPool::index_type() const {
+    return _index_type;
+}
+
+std::size_t GeometryPool::index_size() const {
+    return _index_type == GL_UNSIGNED_SHORT ? 2 : 4;
+}
+
+unsigned int GeometryPool::vertex_buffer() const {
+    return _vbo;
+}
+
+unsigned int GeometryPool::index_buffer() const {
+    return _ebo;
+}
+
+void GeometryPool::ensure_capacity(std::size_t vertex_count, std::size_t index_count) {
+    const auto stride = static_cast<std::size_t>(_layout.stride());
+    std::size_t offset;
+    bool grown = false;
+
+    // try the allocation, give it back, and grow if it didn't fit. growing doubles so it stays rare
+    if (_vertices.allocate(vertex_count, offset)) {
+        _vertices.free(offset, vertex_count);
+    } else {
+        const std::size_t old_capacity = _vertices.capacity();
+        const std::size_t new_capacity = std::max(old_capacity * 2, old_capacity + vertex_count);
+        grow_buffer(_vbo, old_capacity * stride, new_capacity * stride);
+        _vertices.grow(new_capacity);
+        grown = true;
+    }
+
+    if (_indices.allocate(index_count, offset)) {
+        _indices.free(offset, index_count);
+    } else {
+        const std::size_t old_capacity = _indices.capacity();
+        const std::size_t new_capacity = std::max(old_capacity * 2, old_capacity + index_count);
+        grow_buffer(_ebo, old_capacity * index_size(), new_capacity * index_size());
+        _indices.grow(new_capacity);
+        grown = true;
+    }
+
+    if (grown) {
+        // the VAO still points at the old buffers
+        glBindVertexArray(_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+        _layout.apply();
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+        glBindVertexArray(0);
+    }
+}
+
+std::size_t GeometryPool::upload_indices(const std::uint32_t* indices, std::size_t index_count) {
+    std::size_t index_offset = 0;
+    _indices.allocate(index_count, index_offset);
+
+    std::vector<std::uint16_t> short_indices;
+    const void* index_data = indices;
+    if (_index_type == GL_UNSIGNED_SHORT) {
+        short_indices.assign(indices, indices + index_count);
+        index_data = short_indices.data();
+    }
+
+    // the element buffer binding is VAO state, so go through the copy target instead of binding our VAO
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(index_offset * index_size()),
+                    static_cast<GLsizeiptr>(index_count * index_size()), index_data);
+    return index_offset;
+}
+
+int GeometryPool::make_handle(const MeshAllocation& allocation, bool owns_vertices) {
+    if (!_free_handles.empty()) {
+        const int handle = _free_handles.back();
+        _free_handles.pop_back();
+        _allocations[static_cast<std::size_t>(handle)] = allocation;
+        _live[static_cast<std::size_t>(handle)] = true;
+        _owns_vertices[static_cast<std::size_t>(handle)] = owns_vertices;
+        return handle;
+    }
+    _allocations.push_back(allocation);
+    _live.push_back(true);
+    _owns_vertices.push_back(owns_vertices);
+    return static_cast<int>(_allocations.size()) - 1;
+}
+
+void GeometryPool::grow_buffer(unsigned int& buffer, std::size_t old_bytes, std::size_t new_bytes) {
+    unsigned int grown;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(new_bytes), nullptr, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(old_bytes));
+
+    glDeleteBuffers(1, &buffer);
+    buffer = grown;
+}
+
+} // tools
@@ -0,0 +1,74 @@
+#include "tools/gl_stats.h"
+#include "glad/glad.h"
+#include <type_traits>
+
+namespace tools {
+
+namespace {
+
+GlCallCounts counts;
+
+using Counter = std::uint64_t GlCallCounts::*;
+
+/**
+ * swaps the glad pointer `function` for `call`, which bumps the counter and forwards to the original
+ */
+template<auto& function, Counter counter, typename = std::remove_reference_t<decltype(function)>>
+struct Counted;
+
+template<auto& function, Counter counter, typename R, typename... Args>
+struct Counted<function, counter, R (APIENTRYP)(Args...)> {
+    static inline R (APIENTRYP original)(Args...) = nullptr;
+
+    static R APIENTRY call(Args... args) {
+        ++(counts.*counter);
+        return original(args...);
+    }
+
+    static void install() {
+        // missing in this context, or already wrapped
+        if (function == nullptr || function == call) {
+            return;
+        }
+        original = function;
+        function = call;
+    }
+};
+
+template<Counter counter, auto&... functions>
+void install() {
+    (Counted<functions, counter>::install(), ...);
+}
+
+} // namespace
+
+void enable_gl_call_counting() {
+    install<&GlCallCounts::draw_calls,
+            glDrawArrays, glDrawElements, glDrawRangeElements,
+            glDrawArraysInstanced, glDrawElementsInstanced,
+            glDrawElementsBaseVertex, glDrawElementsInstancedBaseVertex,
+            glMultiDrawArrays, glMultiDrawElements,
+            glDrawArraysIndirect, glDrawElementsIndirect,
+            glMultiDrawArraysIndirect, glMultiDrawElementsIndirect>();
+
+    install<&GlCallCounts::state_changes,
+            glUseProgram, glBindVertexArray, glBindBuffer, glBindBufferBase, glBindBufferRange,
+            glActiveTexture, glBindTexture, glBindSampler, glBindFramebuffer,
+            glEnable, glDisable, glBlendFunc, glBlendFuncSeparate, glDepthFunc, glDepthMask, glCullFace,
+            glColorMask, glPolygonMode, glViewport, glClearColor>();
+
+    install<&GlCallCounts::uniform_updates,
+            glUniform1i, glUniform1f, glUniform2f, glUniform3f, glUniform4f,
+            glUniform1iv, glUniform1fv, glUniform2fv, glUniform3fv, glUniform4fv,
+            glUniformMatrix3fv, glUniformMatrix4fv>();
+}
+
+const GlCallCounts& gl_call_counts() {
+    return counts;
+}
+
+void reset_gl_call_counts() {
+    counts = {};
+}
+
+} // tools
@@ -0,0 +1,243 @@
+#include "tools/gpu_culler.h"
+#include "tools/draw_queue.h"
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace tools {
+
+namespace {
+
+const char* const cull_source = R"(#version 430
+layout(local_size_x = 64) in;
+
+struct Instance {
+    vec4 sphere;
+    uint command;
+    uint record;
+    uint padding0;
+    uint padding1;
+};
+
+struct Command {
+    uint count;
+    uint instance_count;
+    uint first_index;
+    int base_vertex;
+    uint base_instance;
+};
+
+layout(std430, binding = 0) readonly buffer Instances { Instance instances[]; };
+layout(std430, binding = 1) buffer Commands { Command commands[]; };
+layout(std430, binding = 2) writeonly buffer Visible { uint visible[]; };
+layout(binding = 0, offset = 0) uniform atomic_uint visible_total;
+
+uniform vec4 planes[6];
+uniform uint instance_count;
+
+void main() {
+    uint i = gl_GlobalInvocationID.x;
+    if (i >= instance_count) {
+        return;
+    }
+    Instance instance = instances[i];
+    for (int p = 0; p < 6; ++p) {
+        if (dot(planes[p].xyz, instance.sphere.xyz) + planes[p].w < -instance.sphere.w) {
+            return;
+        }
+    }
+    uint slot = atomicAdd(commands[instance.command].instance_count, 1u);
+    visible[commands[instance.command].base_instance + slot] = instance.record;
+    atomicCounterIncrement(visible_total);
+}
+)";
+
+constexpr unsigned int group_size = 64;
+
+unsigned int compile_cull_program() {
+    const unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
+    glShaderSource(shader, 1, &cull_source, nullptr);
+    glCompileShader(shader);
+
+    int success;
+    char info_log[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, nullptr, info_log);
+        std::cerr << "ERROR::GPU_CULLER::COMPILATION_FAILED\n" << info_log << std::endl;
+    }
+
+    const unsigned int program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, info_log);
+        std::cerr << "ERROR::GPU_CULLER::LINKING_FAILED\n" << info_log << std::endl;
+    }
+    glDeleteShader(shader);
+    return program;
+}
+
+} // namespace
+
+GpuCuller::GpuCuller(GLuint draw_id_location) : _draw_id_location(draw_id_location) {
+    _supported = GLAD_GL_VERSION_4_3;
+    if (!_supported) {
+        std::cerr << "ERROR::GPU_CULLER::NEEDS_GL_4_3" << std::endl;
+        return;
+    }
+
+    _program = compile_cull_program();
+    _planes_location = glGetUniformLocation(_program, "planes");
+    _instance_count_location = glGetUniformLocation(_program, "instance_count");
+
+    glGenBuffers(1, &_instance_buffer);
+    glGenBuffers(1, &_template_buffer);
+    glGenBuffers(1, &_command_buffer);
+    glGenBuffers(1, &_visible_buffer);
+    glGenBuffers(1, &_counter_buffer);
+
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, _counter_buffer);
+    glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(std::uint32_t), nullptr, GL_DYNAMIC_COPY);
+}
+
+GpuCuller::~GpuCuller() {
+    if (!_supported) {
+        return;
+    }
+    glDeleteProgram(_program);
+    glDeleteBuffers(1, &_instance_buffer);
+    glDeleteBuffers(1, &_template_buffer);
+    glDeleteBuffers(1, &_command_buffer);
+    glDeleteBuffers(1, &_visible_buffer);
+    glDeleteBuffers(1, &_counter_buffer);
+}
+
+bool GpuCuller::set_instances(const GeometryPool& pool, std::span<const GpuInstance> instances) {
+    if (!_supported) {
+        return false;
+    }
+    // a removed mesh would be drawn from a range that's free (or someone else's) by now
+    for (const GpuInstance& instance: instances) {
+        if (!pool.valid(instance.mesh)) {
+            std::cerr << "ERROR::GPU_CULLER::INVALID_MESH: " << instance.mesh << std::endl;
+            return false;
+        }
+    }
+    _pool = &pool;
+    _instance_count = static_cast<std::uint32_t>(instances.size());
+
+    // one command per distinct mesh, in order of first appearance
+    std::unordered_map<int, std::uint32_t> command_of_mesh;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<GpuInstance> uploaded(instances.begin(), instances.end());
+    for (GpuInstance& instance: uploaded) {
+        const auto [found, inserted] = command_of_mesh.try_emplace(instance.mesh,
+                                                                   static_cast<std::uint32_t>(commands.size()));
+        if (inserted) {
+            const MeshAllocation& allocation = pool.allocation(instance.mesh);
+            commands.push_back({allocation.index_count, 0, allocation.first_index,
+                                static_cast<std::int32_t>(allocation.base_vertex), 0});
+        }
+        // counted in base_instance for now, turned into offsets below
+        ++commands[found->second].base_instance;
+        instance.mesh = static_cast<std::int32_t>(found->second);
+    }
+
+    std::uint32_t offset = 0;
+    for (DrawElementsIndirectCommand& command: commands) {
+        const std::uint32_t count = command.base_instance;
+        command.base_instance = offset;
+        offset += count;
+    }
+    _command_count = static_cast<GLsizei>(commands.size());
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _instance_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(uploaded.size() * sizeof(GpuInstance)),
+                 uploaded.data(), GL_DYNAMIC_DRAW);
+
+    const auto command_bytes = static_cast<GLsizeiptr>(commands.size() * sizeof(DrawElementsIndirectCommand));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _template_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, command_bytes, commands.data(), GL_STATIC_COPY);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _command_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, command_bytes, nullptr, GL_DYNAMIC_COPY);
+
+    // a slot for every instance, written by the cull and read as a vertex attribute
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _visible_buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(std::max<std::size_t>(instances.size(), 1) *
+                                                               sizeof(std::uint32_t)), nullptr, GL_DYNAMIC_COPY);
+    return true;
+}
+
+void GpuCuller::cull(const Frustum& frustum) {
+    if (!_supported || _command_count == 0) {
+        return;
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, _template_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _command_buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                        static_cast<GLsizeiptr>(_command_count * sizeof(DrawElementsIndirectCommand)));
+    glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, _counter_buffer);
+    glClearBufferData(GL_ATOMIC_COUNTER_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+    glm::vec4 planes[6];
+    for (int p = 0; p < 6; ++p) {
+        planes[p] = glm::vec4(frustum.planes[p].normal, frustum.planes[p].distance);
+    }
+    glUseProgram(_program);
+    glUniform4fv(_planes_location, 6, &planes[0].x);
+    glUniform1ui(_instance_count_location, _instance_count);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _instance_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _command_buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _visible_buffer);
+    glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, _counter_buffer);
+
+    glDispatchCompute((_instance_count + group_size - 1) / group_size, 1, 1);
+
+    // the commands are read by the indirect draw and the visible list as a vertex attribute. buffer update covers
+    // read_visible_count()'s glGetBufferSubData and the next cull's copy and clear into the same buffers
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT |
+                    GL_BUFFER_UPDATE_BARRIER_BIT);
+}
+
+int GpuCuller::draw() const {
+    if (!_supported || _command_count == 0) {
+        return 0;
+    }
+
+    _pool->bind();
+    glBindBuffer(GL_ARRAY_BUFFER, _visible_buffer);
+    glVertexAttribIPointer(_draw_id_location, 1, GL_UNSIGNED_INT, sizeof(std::uint32_t), nullptr);
+    glVertexAttribDivisor(_draw_id_location, 1);
+    glEnableVertexAttribArray(_draw_id_location);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _command_buffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, _pool->index_type(), nullptr, _command_count, 0);
+    // the VAO is the pool's, a plain GeometryPool::draw after this mustn't fetch from the visible list
+    glDisableVertexAttribArray(_draw_id_location);
+    glBindVertexArray(0);
+    return 1;
+}
+
+std::uint32_t GpuCuller::read_visible_count() const {
+    std::uint32_t count = 0;
+    if (_supported) {
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, _counter_buffer);
+        glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(std::uint32_t), &count);
+    }
+    return count;
+}
+
+unsigned int GpuCuller::instance_buffer() const {
+    return _instance_buffer;
+}
+
+bool GpuCuller::supported() const {
+    return _supported;
+}
+
+} // tools
@@ -0,0 +1,111 @@
+#include "tools/headless_context.h"
+#include "glad/glad.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <iostream>
+
+namespace tools {
+
+namespace {
+
+bool has_extension(const char* extensions, const char* name) {
+    if (extensions == nullptr) {
+        return false;
+    }
+    const std::size_t length = std::strlen(name);
+    for (const char* found = std::strstr(extensions, name); found != nullptr; found = std::strstr(found + 1, name)) {
+        const bool starts = found == extensions || found[-1] == ' ';
+        const bool ends = found[length] == ' ' || found[length] == '\0';
+        if (starts && ends) {
+            return true;
+        }
+    }
+    return false;
+}
+
+EGLDisplay open_display() {
+    // client extensions, queried without a display
+    const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (has_extension(client_extensions, "EGL_MESA_platform_surfaceless")) {
+        auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (get_platform_display != nullptr) {
+            EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY) {
+                return display;
+            }
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+} // namespace
+
+HeadlessContext::HeadlessContext(int gl_major, int gl_minor) {
+    EGLDisplay display = open_display();
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        std::cerr << "ERROR::HEADLESS_CONTEXT::NO_DISPLAY" << std::endl;
+        return;
+    }
+    _display = display;
+
+    if (!has_extension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context")) {
+        std::cerr << "ERROR::HEADLESS_CONTEXT::SURFACELESS_UNSUPPORTED" << std::endl;
+        return;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "ERROR::HEADLESS_CONTEXT::NO_DESKTOP_GL" << std::endl;
+        return;
+    }
+
+    const EGLint config_attributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config = nullptr;
+    EGLint config_count = 0;
+    eglChooseConfig(display, config_attributes, &config, 1, &config_count);
+
+    const EGLint context_attributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, gl_major,
+            EGL_CONTEXT_MINOR_VERSION, gl_minor,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+    };
+    // surfaceless contexts don't need a config, some drivers have none without a window system
+    EGLContext context = eglCreateContext(display, config_count > 0 ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT,
+                                          context_attributes);
+    if (context == EGL_NO_CONTEXT) {
+        std::cerr << "ERROR::HEADLESS_CONTEXT::CONTEXT_CREATION_FAILED" << std::endl;
+        return;
+    }
+    _context = context;
+
+    make_current();
+
+    if (!gladLoadGLLoader((GLADloadproc) eglGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        eglDestroyContext(display, context);
+        _context = nullptr;
+    }
+}
+
+HeadlessContext::~HeadlessContext() {
+    if (_display == nullptr) {
+        return;
+    }
+    eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (_context != nullptr) {
+        eglDestroyContext(_display, _context);
+    }
+    eglTerminate(_display);
+}
+
+bool HeadlessContext::valid() const {
+    return _context != nullptr;
+}
+
+void HeadlessContext::make_current() {
+    eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, _context);
+}
+
+} // tools
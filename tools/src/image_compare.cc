@@ -0,0 +1,93 @@
+#include "tools/image_compare.h"
+#include <algorithm>
+#include <cmath>
+
+namespace tools {
+
+namespace {
+
+// the largest YIQ delta there is, black against white
+constexpr double max_yiq_delta = 35215.0;
+
+struct Rgb {
+    double r;
+    double g;
+    double b;
+};
+
+Rgb blended(const unsigned char* pixel, int channels) {
+    const double alpha = channels == 4 ? pixel[3] / 255.0 : 1.0;
+    return {255.0 + (pixel[0] - 255.0) * alpha, 255.0 + (pixel[1] - 255.0) * alpha, 255.0 + (pixel[2] - 255.0) * alpha};
+}
+
+double luma(const Rgb& c) {
+    return c.r * 0.29889531 + c.g * 0.58662247 + c.b * 0.11448223;
+}
+
+/**
+ * 0-1, square root of the weighted YIQ distance so it grows linearly with the colour difference
+ */
+double yiq_delta(const Rgb& a, const Rgb& b) {
+    const double y = luma(a) - luma(b);
+    const double i = (a.r * 0.59597799 - a.g * 0.27417610 - a.b * 0.32180189) -
+                     (b.r * 0.59597799 - b.g * 0.27417610 - b.b * 0.32180189);
+    const double q = (a.r * 0.21147017 - a.g * 0.52261711 + a.b * 0.31114694) -
+                     (b.r * 0.21147017 - b.g * 0.52261711 + b.b * 0.31114694);
+    return std::sqrt((0.5053 * y * y + 0.299 * i * i + 0.1957 * q * q) / max_yiq_delta);
+}
+
+} // namespace
+
+ImageDifference compare_images(const Image& a, const Image& b, double threshold, Image* diff) {
+    ImageDifference difference;
+    difference.same_size = a.width == b.width && a.height == b.height;
+    const bool comparable = a.channels >= 3 && b.channels >= 3;
+    if (!difference.same_size || !comparable) {
+        difference.differing_pixels = static_cast<std::size_t>(std::max(a.width * a.height, b.width * b.height));
+        difference.differing_fraction = 1.0;
+        difference.max_delta = 1.0;
+        difference.mean_delta = 1.0;
+        return difference;
+    }
+
+    const std::size_t count = static_cast<std::size_t>(a.width) * a.height;
+    if (count == 0) {
+        return difference;
+    }
+    if (diff != nullptr) {
+        diff->width = a.width;
+        diff->height = a.height;
+        diff->channels = 4;
+        diff->pixels.resize(count * 4);
+    }
+
+    double total = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const Rgb colour_a = blended(&a.pixels[i * a.channels], a.channels);
+        const Rgb colour_b = blended(&b.pixels[i * b.channels], b.channels);
+        const double delta = yiq_delta(colour_a, colour_b);
+        total += delta;
+        difference.max_delta = std::max(difference.max_delta, delta);
+        const bool differs = delta > threshold;
+        difference.differing_pixels += differs;
+
+        if (diff != nullptr) {
+            unsigned char* out = &diff->pixels[i * 4];
+            if (differs) {
+                out[0] = 255;
+                out[1] = 0;
+                out[2] = 0;
+            } else {
+                const auto grey = static_cast<unsigned char>(255.0 - (255.0 - luma(colour_a)) * 0.1);
+                out[0] = out[1] = out[2] = grey;
+            }
+            out[3] = 255;
+        }
+    }
+
+    difference.differing_fraction = static_cast<double>(difference.differing_pixels) / static_cast<double>(count);
+    difference.mean_delta = total / static_cast<double>(count);
+    return difference;
+}
+
+} // tools
@@ -0,0 +1,300 @@
+#include "tools/input.h"
+#include "tools/input_recording.h"
+#include <algorithm>
+
+namespace tools {
+
+namespace {
+
+template<std::size_t N>
+bool test(const std::bitset<N>& bits, int index) {
+    return index >= 0 && static_cast<std::size_t>(index) < N && bits.test(static_cast<std::size_t>(index));
+}
+
+} // namespace
+
+bool InputState::key_down(int key) const {
+    return test(_keys_down, key);
+}
+
+bool InputState::key_pressed(int key) const {
+    return test(_keys_pressed, key);
+}
+
+bool InputState::key_released(int key) const {
+    return test(_keys_released, key);
+}
+
+bool InputState::button_down(int button) const {
+    return test(_buttons_down, button);
+}
+
+bool InputState::button_pressed(int button) const {
+    return test(_buttons_pressed, button);
+}
+
+bool InputState::button_released(int button) const {
+    return test(_buttons_released, button);
+}
+
+double InputState::cursor_x() const {
+    return _cursor_x;
+}
+
+double InputState::cursor_y() const {
+    return _cursor_y;
+}
+
+double InputState::cursor_dx() const {
+    return _cursor_dx;
+}
+
+double InputState::cursor_dy() const {
+    return _cursor_dy;
+}
+
+double InputState::scroll_x() const {
+    return _scroll_x;
+}
+
+double InputState::scroll_y() const {
+    return _scroll_y;
+}
+
+int InputState::framebuffer_width() const {
+    return _framebuffer_width;
+}
+
+int InputState::framebuffer_height() const {
+    return _framebuffer_height;
+}
+
+std::vector<InputEvent> InputState::as_events() const {
+    std::vector<InputEvent> events;
+    for (int key = 0; key <= GLFW_KEY_LAST; ++key) {
+        if (_keys_down.test(static_cast<std::size_t>(key))) {
+            events.push_back({InputEventType::key, GLFW_PRESS, 0, key, 0.0, 0.0});
+        }
+    }
+    for (int button = 0; button <= GLFW_MOUSE_BUTTON_LAST; ++button) {
+        if (_buttons_down.test(static_cast<std::size_t>(button))) {
+            events.push_back({InputEventType::mouse_button, GLFW_PRESS, 0, button, 0.0, 0.0});
+        }
+    }
+    if (_has_cursor) {
+        events.push_back({InputEventType::cursor, 0, 0, 0, _cursor_x, _cursor_y});
+    }
+    if (_framebuffer_width != 0 || _framebuffer_height != 0) {
+        events.push_back({InputEventType::resize, 0, 0, 0, static_cast<double>(_framebuffer_width),
+                          static_cast<double>(_framebuffer_height)});
+    }
+    return events;
+}
+
+void InputState::begin_frame() {
+    _keys_pressed.reset();
+    _keys_released.reset();
+    _buttons_pressed.reset();
+    _buttons_released.reset();
+    _cursor_dx = 0.0;
+    _cursor_dy = 0.0;
+    _scroll_x = 0.0;
+    _scroll_y = 0.0;
+}
+
+void InputState::apply(const InputEvent& event) {
+    switch (event.type) {
+        case InputEventType::key:
+            // GLFW_KEY_UNKNOWN is -1
+            if (event.code >= 0 && event.code <= GLFW_KEY_LAST && event.action != GLFW_REPEAT) {
+                const bool down = event.action == GLFW_PRESS;
+                _keys_down.set(static_cast<std::size_t>(event.code), down);
+                (down ? _keys_pressed : _keys_released).set(static_cast<std::size_t>(event.code));
+            }
+            break;
+        case InputEventType::mouse_button:
+            if (event.code >= 0 && event.code <= GLFW_MOUSE_BUTTON_LAST) {
+                const bool down = event.action == GLFW_PRESS;
+                _buttons_down.set(static_cast<std::size_t>(event.code), down);
+                (down ? _buttons_pressed : _buttons_released).set(static_cast<std::size_t>(event.code));
+            }
+            break;
+        case InputEventType::cursor:
+            if (_has_cursor) {
+                _cursor_dx += event.x - _cursor_x;
+                _cursor_dy += event.y - _cursor_y;
+            }
+            _cursor_x = event.x;
+            _cursor_y = event.y;
+            _has_cursor = true;
+            break;
+        case InputEventType::scroll:
+            _scroll_x += event.x;
+            _scroll_y += event.y;
+            break;
+        case InputEventType::resize:
+            _framebuffer_width = static_cast<int>(event.x);
+            _framebuffer_height = static_cast<int>(event.y);
+            break;
+    }
+}
+
+Input::Input() = default;
+
+Input::~Input() {
+    stop_recording();
+}
+
+void Input::push(const InputEvent& event) {
+    if (!_ring.push(event)) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Input::update() {
+    _state.begin_frame();
+    _events.clear();
+
+    double step = next_step();
+    if (_replay && !_replay->next(step, _events)) {
+        _replay.reset();
+    }
+    // still drained while replaying, the window's own events would make the run differ from the recording
+    InputEvent event{};
+    while (_ring.pop(event)) {
+        if (!_replay) {
+            _events.push_back(event);
+        }
+    }
+    for (const InputEvent& e: _events) {
+        _state.apply(e);
+    }
+
+    _time += step;
+    _delta_time = step;
+    ++_frame;
+    if (_recorder) {
+        _recorder->write_frame(step, _events);
+    }
+
+    // after the whole frame is applied, so a listener sees the same snapshot as the rest of the frame.
+    // listeners adding or removing listeners don't touch _listeners while it's iterated, see add / remove
+    _dispatching = true;
+    for (const InputEvent& e: _events) {
+        for (const Registration& registration: _listeners) {
+            if (registration.type == e.type && !registration.removed) {
+                registration.listener(e);
+            }
+        }
+    }
+    _dispatching = false;
+    std::erase_if(_listeners, [](const Registration& registration) { return registration.removed; });
+    for (Registration& registration: _added) {
+        _listeners.push_back(std::move(registration));
+    }
+    _added.clear();
+}
+
+const InputState& Input::state() const {
+    return _state;
+}
+
+std::span<const InputEvent> Input::events() const {
+    return _events;
+}
+
+int Input::add_listener(InputEventType type, Listener listener) {
+    (_dispatching ? _added : _listeners).push_back({_next_id, type, std::move(listener), false});
+    return _next_id++;
+}
+
+void Input::remove_listener(int id) {
+    const auto matches = [id](const Registration& registration) { return registration.id == id; };
+    std::erase_if(_added, matches);
+    if (!_dispatching) {
+        std::erase_if(_listeners, matches);
+        return;
+    }
+    // a listener removing itself (or another one) mid dispatch: skipped from now on, erased after it
+    for (Registration& registration: _listeners) {
+        if (matches(registration)) {
+            registration.removed = true;
+        }
+    }
+}
+
+std::uint64_t Input::dropped() const {
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+double Input::time() const {
+    return _time;
+}
+
+double Input::delta_time() const {
+    return _delta_time;
+}
+
+std::uint64_t Input::frame() const {
+    return _frame;
+}
+
+void Input::set_fixed_step(double seconds) {
+    _fixed_step = std::max(0.0, seconds);
+}
+
+bool Input::start_recording(const std::string& path) {
+    stop_recording();
+    // the frames it writes advance from here, a replay starts from the same time and snapshot
+    _recorder = std::make_unique<InputRecorder>(path, _time, _state.as_events());
+    if (!_recorder->ok()) {
+        _recorder.reset();
+        return false;
+    }
+    return true;
+}
+
+bool Input::stop_recording() {
+    if (!_recorder) {
+        return true;
+    }
+    const bool ok = _recorder->finish();
+    _recorder.reset();
+    return ok;
+}
+
+bool Input::recording() const {
+    return _recorder != nullptr;
+}
+
+bool Input::start_replay(const std::string& path) {
+    auto replay = std::make_unique<InputReplay>(path);
+    if (!replay->ok()) {
+        return false;
+    }
+    _state = InputState{};
+    for (const InputEvent& event: replay->initial()) {
+        _state.apply(event);
+    }
+    _time = replay->start_time();
+    _replay = std::move(replay);
+    return true;
+}
+
+void Input::stop_replay() {
+    _replay.reset();
+}
+
+bool Input::replaying() const {
+    return _replay != nullptr;
+}
+
+double Input::next_step() {
+    // read every frame, so the wall clock step after a replay is one frame's and not the whole replay's
+    const double clock = glfwGetTime();
+    const double step = _last_clock < 0.0 ? 0.0 : clock - _last_clock;
+    _last_clock = clock;
+    return _fixed_step > 0.0 ? _fixed_step : step;
+}
+
+} // tools
@@ -0,0 +1,173 @@
+#include "tools/input_recording.h"
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <type_traits>
+
+namespace tools {
+
+namespace {
+
+constexpr char magic[4] = {'I', 'N', 'P', 'T'};
+constexpr std::uint32_t version = 1;
+
+// events go to the file byte for byte, that needs no padding to leave undefined bytes in it
+static_assert(std::is_trivially_copyable_v<InputEvent> && sizeof(InputEvent) == 24);
+
+template<typename T>
+void write_value(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write_events(std::ofstream& file, std::span<const InputEvent> events) {
+    write_value(file, static_cast<std::uint32_t>(events.size()));
+    file.write(reinterpret_cast<const char*>(events.data()),
+               static_cast<std::streamsize>(events.size_bytes()));
+}
+
+/**
+ * reads out of the whole file, false once it would run past the end
+ */
+class Reader {
+public:
+    explicit Reader(const std::vector<char>& data) : _data(data) {}
+
+    template<typename T>
+    bool read(T& value) {
+        if (_data.size() - _offset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, _data.data() + _offset, sizeof(T));
+        _offset += sizeof(T);
+        return true;
+    }
+
+    bool read_events(std::vector<InputEvent>& events) {
+        std::uint32_t count;
+        if (!read(count) || (_data.size() - _offset) / sizeof(InputEvent) < count) {
+            return false;
+        }
+        const std::size_t first = events.size();
+        events.resize(first + count);
+        std::memcpy(events.data() + first, _data.data() + _offset, count * sizeof(InputEvent));
+        _offset += count * sizeof(InputEvent);
+        return true;
+    }
+
+    bool at_end() const {
+        return _offset == _data.size();
+    }
+
+private:
+    const std::vector<char>& _data;
+    std::size_t _offset = 0;
+};
+
+} // namespace
+
+InputRecorder::InputRecorder(const std::string& path, double start_time, std::span<const InputEvent> initial)
+        : _file(path, std::ios::binary), _path(path) {
+    if (!_file) {
+        std::cerr << "ERROR::INPUT_RECORDER::FAILED_TO_OPEN: " << path << std::endl;
+        _failed = true;
+        return;
+    }
+    _file.write(magic, sizeof(magic));
+    write_value(_file, version);
+    write_value(_file, start_time);
+    write_events(_file, initial);
+}
+
+void InputRecorder::write_frame(double step, std::span<const InputEvent> events) {
+    if (_failed) {
+        return;
+    }
+    write_value(_file, step);
+    write_events(_file, events);
+    if (!_file) {
+        std::cerr << "ERROR::INPUT_RECORDER::FAILED_TO_WRITE: " << _path << std::endl;
+        _failed = true;
+        return;
+    }
+    ++_frames;
+}
+
+bool InputRecorder::finish() {
+    if (_file.is_open()) {
+        _file.close();
+        if (!_file && !_failed) {
+            std::cerr << "ERROR::INPUT_RECORDER::FAILED_TO_WRITE: " << _path << std::endl;
+            _failed = true;
+        }
+    }
+    return !_failed;
+}
+
+bool InputRecorder::ok() const {
+    return !_failed;
+}
+
+std::uint64_t InputRecorder::frames_written() const {
+    return _frames;
+}
+
+InputReplay::InputReplay(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "ERROR::INPUT_REPLAY::FAILED_TO_OPEN: " << path << std::endl;
+        return;
+    }
+    const std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    Reader reader(data);
+
+    char file_magic[4];
+    std::uint32_t file_version;
+    if (!reader.read(file_magic) || std::memcmp(file_magic, magic, sizeof(magic)) != 0 ||
+        !reader.read(file_version) || file_version != version) {
+        std::cerr << "ERROR::INPUT_REPLAY::INVALID_HEADER: " << path << std::endl;
+        return;
+    }
+    if (!reader.read(_start_time) || !reader.read_events(_initial)) {
+        std::cerr << "ERROR::INPUT_REPLAY::TRUNCATED: " << path << std::endl;
+        return;
+    }
+    while (!reader.at_end()) {
+        Frame frame{0.0, _events.size(), 0};
+        if (!reader.read(frame.step) || !reader.read_events(_events)) {
+            std::cerr << "ERROR::INPUT_REPLAY::TRUNCATED: " << path << std::endl;
+            return;
+        }
+        frame.count = _events.size() - frame.first;
+        _frames.push_back(frame);
+    }
+    _ok = true;
+}
+
+bool InputReplay::ok() const {
+    return _ok;
+}
+
+double InputReplay::start_time() const {
+    return _start_time;
+}
+
+std::span<const InputEvent> InputReplay::initial() const {
+    return _initial;
+}
+
+bool InputReplay::next(double& step, std::vector<InputEvent>& events) {
+    if (!_ok || _next == _frames.size()) {
+        return false;
+    }
+    const Frame& frame = _frames[_next++];
+    step = frame.step;
+    events.assign(_events.begin() + static_cast<std::ptrdiff_t>(frame.first),
+                  _events.begin() + static_cast<std::ptrdiff_t>(frame.first + frame.count));
+    return true;
+}
+
+std::uint64_t InputReplay::frame_count() const {
+    return _frames.size();
+}
+
+} // tools
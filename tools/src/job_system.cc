@@ -0,0 +1,177 @@
+#include "tools/job_system.h"
+
+namespace tools {
+
+namespace {
+
+// which worker of which system the current thread is, so jobs it queues go on its own deque
+thread_local const JobSystem* current_system = nullptr;
+thread_local unsigned int current_worker = 0;
+
+} // namespace
+
+bool JobGroup::done() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _pending == 0;
+}
+
+JobSystem::JobSystem(unsigned int worker_count) {
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    }
+    for (unsigned int i = 0; i <= worker_count; ++i) {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned int i = 0; i < worker_count; ++i) {
+        _workers.emplace_back(&JobSystem::worker_loop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+        // workers drain the deques before they see this
+        _stopping = true;
+    }
+    _wake.notify_all();
+    for (auto& worker: _workers) {
+        worker.join();
+    }
+    // nothing left to run jobs queued by the last ones
+    Job job;
+    while (try_pop(job)) {
+        job.work();
+        finish(*job.group);
+    }
+}
+
+JobSystem& JobSystem::shared() {
+    static JobSystem system;
+    return system;
+}
+
+void JobSystem::run(JobGroup& group, std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(group._mutex);
+        ++group._pending;
+    }
+    push({std::move(job), &group});
+}
+
+void JobSystem::then(JobGroup& dependency, JobGroup& group, std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(group._mutex);
+        ++group._pending;
+    }
+    {
+        std::lock_guard<std::mutex> lock(dependency._mutex);
+        if (dependency._pending != 0) {
+            dependency._continuations.push_back({std::move(job), &group});
+            return;
+        }
+    }
+    push({std::move(job), &group});
+}
+
+void JobSystem::wait(JobGroup& group) {
+    while (!group.done()) {
+        if (run_one()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_sleep_mutex);
+        _wake.wait(lock, [this, &group] { return _queued.load() > 0 || group.done(); });
+    }
+}
+
+unsigned int JobSystem::worker_count() const {
+    return static_cast<unsigned int>(_workers.size());
+}
+
+void JobSystem::push(Job job) {
+    const bool worker = current_system == this;
+    Queue& queue = *_queues[worker ? current_worker : _queues.size() - 1];
+    _queued.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    {
+        // taking the lock orders this after a sleeper's check, so the wake up can't get lost
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+    }
+    _wake.notify_one();
+}
+
+bool JobSystem::try_pop(Job& job) {
+    const std::size_t count = _queues.size();
+    const std::size_t own = current_system == this ? current_worker : count - 1;
+
+    // own deque newest first, everybody else's oldest first
+    {
+        Queue& queue = *_queues[own];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            _queued.fetch_sub(1);
+            return true;
+        }
+    }
+    for (std::size_t i = 1; i < count; ++i) {
+        Queue& queue = *_queues[(own + i) % count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            _queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::run_one() {
+    Job job;
+    if (!try_pop(job)) {
+        return false;
+    }
+    job.work();
+    finish(*job.group);
+    return true;
+}
+
+void JobSystem::finish(JobGroup& group) {
+    std::vector<JobGroup::Continuation> continuations;
+    {
+        std::lock_guard<std::mutex> lock(group._mutex);
+        if (--group._pending != 0) {
+            return;
+        }
+        continuations.swap(group._continuations);
+    }
+    // the group may be gone from here on, its waiter can return as soon as the lock is released
+    for (auto& continuation: continuations) {
+        push({std::move(continuation.work), continuation.group});
+    }
+    {
+        std::lock_guard<std::mutex> lock(_sleep_mutex);
+    }
+    _wake.notify_all();
+}
+
+void JobSystem::worker_loop(unsigned int index) {
+    current_system = this;
+    current_worker = index;
+    while (true) {
+        if (run_one()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_sleep_mutex);
+        _wake.wait(lock, [this] { return _stopping || _queued.load() > 0; });
+        if (_stopping && _queued.load() == 0) {
+            return;
+        }
+    }
+}
+
+} // tools
@@ -0,0 +1,237 @@
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// just enough json for glTF headers. internal to tools, no writer, no \u escapes beyond ascii.
+namespace tools::json {
+
+struct Value {
+    enum class Type {
+        null,
+        boolean,
+        number,
+        string,
+        array,
+        object
+    };
+
+    Type type = Type::null;
+    bool boolean = false;
+    double number = 0.0;
+    std::string string;
+    std::vector<Value> array;
+    std::vector<std::pair<std::string, Value>> object;
+
+    const Value& operator[](std::string_view key) const {
+        for (const auto& [name, value]: object) {
+            if (name == key) {
+                return value;
+            }
+        }
+        return null_value();
+    }
+
+    const Value& operator[](std::size_t index) const {
+        return index < array.size() ? array[index] : null_value();
+    }
+
+    bool has(std::string_view key) const {
+        return &(*this)[key] != &null_value();
+    }
+
+    std::size_t size() const {
+        return type == Type::array ? array.size() : object.size();
+    }
+
+    long long as_int(long long fallback = 0) const {
+        return type == Type::number ? static_cast<long long>(number) : fallback;
+    }
+
+    double as_number(double fallback = 0.0) const {
+        return type == Type::number ? number : fallback;
+    }
+
+    static const Value& null_value() {
+        static const Value null;
+        return null;
+    }
+};
+
+class Parser {
+public:
+    explicit Parser(std::string_view text) : _text(text) {
+    }
+
+    bool parse(Value& out) {
+        return parse_value(out, 0) && (skip_whitespace(), _position == _text.size());
+    }
+
+private:
+    static constexpr int max_depth = 64;
+
+    void skip_whitespace() {
+        while (_position < _text.size() &&
+               (_text[_position] == ' ' || _text[_position] == '\n' || _text[_position] == '\r' ||
+                _text[_position] == '\t')) {
+            ++_position;
+        }
+    }
+
+    bool consume(char expected) {
+        skip_whitespace();
+        if (_position < _text.size() && _text[_position] == expected) {
+            ++_position;
+            return true;
+        }
+        return false;
+    }
+
+    bool consume_literal(std::string_view literal) {
+        if (_text.substr(_position, literal.size()) == literal) {
+            _position += literal.size();
+            return true;
+        }
+        return false;
+    }
+
+    bool parse_value(Value& out, int depth) {
+        if (depth > max_depth) {
+            return false;
+        }
+        skip_whitespace();
+        if (_position >= _text.size()) {
+            return false;
+        }
+
+        switch (_text[_position]) {
+            case '{':
+                return parse_object(out, depth);
+            case '[':
+                return parse_array(out, depth);
+            case '"':
+                out.type = Value::Type::string;
+                return parse_string(out.string);
+            case 't':
+                out.type = Value::Type::boolean;
+                out.boolean = true;
+                return consume_literal("true");
+            case 'f':
+                out.type = Value::Type::boolean;
+                return consume_literal("false");
+            case 'n':
+                return consume_literal("null");
+            default:
+                return parse_number(out);
+        }
+    }
+
+    bool parse_number(Value& out) {
+        out.type = Value::Type::number;
+        const char* begin = _text.data() + _position;
+        const char* end = _text.data() + _text.size();
+        const auto [next, error] = std::from_chars(begin, end, out.number);
+        if (error != std::errc()) {
+            return false;
+        }
+        _position += static_cast<std::size_t>(next - begin);
+        return true;
+    }
+
+    bool parse_string(std::string& out) {
+        ++_position; // opening quote
+        while (_position < _text.size()) {
+            const char c = _text[_position++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+            if (_position >= _text.size()) {
+                return false;
+            }
+            const char escaped = _text[_position++];
+            switch (escaped) {
+                case 'n':
+                    out.push_back('\n');
+                    break;
+                case 't':
+                    out.push_back('\t');
+                    break;
+                case 'r':
+                    out.push_back('\r');
+                    break;
+                case 'b':
+                    out.push_back('\b');
+                    break;
+                case 'f':
+                    out.push_back('\f');
+                    break;
+                case 'u': {
+                    unsigned int code = 0;
+                    const char* begin = _text.data() + _position;
+                    if (_position + 4 > _text.size() ||
+                        std::from_chars(begin, begin + 4, code, 16).ptr != begin + 4) {
+                        return false;
+                    }
+                    _position += 4;
+                    out.push_back(code < 0x80 ? static_cast<char>(code) : '?');
+                    break;
+                }
+                default:
+                    out.push_back(escaped);
+                    break;
+            }
+        }
+        return false;
+    }
+
+    bool parse_array(Value& out, int depth) {
+        out.type = Value::Type::array;
+        ++_position;
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            out.array.emplace_back();
+            if (!parse_value(out.array.back(), depth + 1)) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(']');
+    }
+
+    bool parse_object(Value& out, int depth) {
+        out.type = Value::Type::object;
+        ++_position;
+        if (consume('}')) {
+            return true;
+        }
+        do {
+            skip_whitespace();
+            if (_position >= _text.size() || _text[_position] != '"') {
+                return false;
+            }
+            out.object.emplace_back();
+            if (!parse_string(out.object.back().first) || !consume(':') ||
+                !parse_value(out.object.back().second, depth + 1)) {
+                return false;
+            }
+        } while (consume(','));
+        return consume('}');
+    }
+
+    std::string_view _text;
+    std::size_t _position = 0;
+};
+
+inline bool parse(std::string_view text, Value& out) {
+    return Parser(text).parse(out);
+}
+
+}
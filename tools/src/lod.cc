@@ -0,0 +1,369 @@
+#include "tools/lod.h"
+#include "tools/mesh_optimizer.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+namespace tools {
+
+namespace {
+
+/**
+ * sum of squared distances to a set of planes, as the symmetric 4x4 matrix [A b; b c].
+ * area weighted, and divided by the total weight when evaluated, so the error is a mean squared distance
+ */
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0;
+
+    Quadric& operator+=(const Quadric& other) {
+        a00 += other.a00;
+        a01 += other.a01;
+        a02 += other.a02;
+        a11 += other.a11;
+        a12 += other.a12;
+        a22 += other.a22;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+};
+
+Quadric plane_quadric(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    const glm::vec3 normal = glm::cross(b - a, c - a);
+    const float length = glm::length(normal);
+    Quadric q;
+    if (length == 0.0f) {
+        return q;
+    }
+    const double area = 0.5 * length;
+    const double nx = normal.x / length, ny = normal.y / length, nz = normal.z / length;
+    const double d = -(nx * a.x + ny * a.y + nz * a.z);
+    q.a00 = area * nx * nx;
+    q.a01 = area * nx * ny;
+    q.a02 = area * nx * nz;
+    q.a11 = area * ny * ny;
+    q.a12 = area * ny * nz;
+    q.a22 = area * nz * nz;
+    q.b0 = area * nx * d;
+    q.b1 = area * ny * d;
+    q.b2 = area * nz * d;
+    q.c = area * d * d;
+    q.weight = area;
+    return q;
+}
+
+double evaluate(const Quadric& q, const glm::vec3& p) {
+    if (q.weight == 0.0) {
+        return 0.0;
+    }
+    const double x = p.x, y = p.y, z = p.z;
+    const double error = q.a00 * x * x + 2 * q.a01 * x * y + 2 * q.a02 * x * z + q.a11 * y * y +
+                         2 * q.a12 * y * z + q.a22 * z * z + 2 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+    return std::max(error / q.weight, 0.0);
+}
+
+struct PositionHash {
+    std::size_t operator()(const glm::vec3& p) const {
+        const std::uint64_t x = std::bit_cast<std::uint32_t>(p.x);
+        const std::uint64_t y = std::bit_cast<std::uint32_t>(p.y);
+        const std::uint64_t z = std::bit_cast<std::uint32_t>(p.z);
+        return static_cast<std::size_t>((x * 73856093u) ^ (y * 19349663u) ^ (z * 83492791u));
+    }
+};
+
+struct PositionEqual {
+    bool operator()(const glm::vec3& a, const glm::vec3& b) const {
+        return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+};
+
+struct Collapse {
+    std::uint32_t from; // vertex indices, not positions
+    std::uint32_t to;
+    double cost;
+};
+
+} // namespace
+
+std::vector<std::uint32_t> simplify(std::span<const std::uint32_t> indices, std::span<const Vertex> vertices,
+                                    std::size_t target_index_count, float max_error, float* result_error) {
+    std::vector<std::uint32_t> result(indices.begin(), indices.end());
+    if (result_error) {
+        *result_error = 0.0f;
+    }
+    if (result.size() <= target_index_count) {
+        return result;
+    }
+
+    // vertices that only differ in uv or normal share a position, topology and error live on positions
+    std::vector<std::uint32_t> position_of(vertices.size());
+    std::vector<glm::vec3> positions;
+    std::vector<std::uint32_t> vertices_at_position;
+    {
+        std::unordered_map<glm::vec3, std::uint32_t, PositionHash, PositionEqual> unique;
+        unique.reserve(vertices.size());
+        for (std::size_t v = 0; v < vertices.size(); ++v) {
+            const auto [found, inserted] = unique.try_emplace(vertices[v].position,
+                                                              static_cast<std::uint32_t>(positions.size()));
+            if (inserted) {
+                positions.push_back(vertices[v].position);
+                vertices_at_position.push_back(0);
+            }
+            position_of[v] = found->second;
+            ++vertices_at_position[found->second];
+        }
+    }
+    const std::size_t position_count = positions.size();
+
+    // seams and open borders stay put, moving them would tear the mesh open
+    std::vector<std::uint8_t> locked(position_count, 0);
+    for (std::size_t p = 0; p < position_count; ++p) {
+        locked[p] = vertices_at_position[p] > 1;
+    }
+    {
+        std::unordered_map<std::uint64_t, int> edge_uses;
+        edge_uses.reserve(result.size());
+        for (std::size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                std::uint64_t a = position_of[result[i + k]];
+                std::uint64_t b = position_of[result[i + (k + 1) % 3]];
+                if (a > b) {
+                    std::swap(a, b);
+                }
+                ++edge_uses[a << 32 | b];
+            }
+        }
+        for (const auto& [edge, uses]: edge_uses) {
+            if (uses == 1) {
+                locked[edge >> 32] = 1;
+                locked[edge & 0xffffffffu] = 1;
+            }
+        }
+    }
+
+    std::vector<Quadric> quadrics(position_count);
+    for (std::size_t i = 0; i < result.size(); i += 3) {
+        const std::uint32_t a = position_of[result[i]];
+        const std::uint32_t b = position_of[result[i + 1]];
+        const std::uint32_t c = position_of[result[i + 2]];
+        const Quadric q = plane_quadric(positions[a], positions[b], positions[c]);
+        quadrics[a] += q;
+        quadrics[b] += q;
+        quadrics[c] += q;
+    }
+
+    const double max_cost = static_cast<double>(max_error) * max_error;
+    double worst_cost = 0.0;
+    std::vector<std::uint32_t> remap(vertices.size());
+    std::vector<std::uint8_t> touched(position_count);
+    std::vector<std::uint32_t> offsets(position_count + 1);
+    std::vector<std::uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+
+    // every pass collapses a set of edges far enough apart that they don't interfere, cheapest first
+    while (result.size() > target_index_count) {
+        const std::size_t triangle_count = result.size() / 3;
+
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (std::uint32_t index: result) {
+            ++offsets[position_of[index] + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        adjacency.resize(result.size());
+        {
+            std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+            for (std::size_t i = 0; i < result.size(); ++i) {
+                adjacency[fill[position_of[result[i]]]++] = static_cast<std::uint32_t>(i / 3);
+            }
+        }
+
+        collapses.clear();
+        for (std::size_t i = 0; i < result.size(); i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                const std::uint32_t a = result[i + k];
+                const std::uint32_t b = result[i + (k + 1) % 3];
+                const std::uint32_t pa = position_of[a];
+                const std::uint32_t pb = position_of[b];
+                // an edge shows up once each way in its two triangles, so a -> b covers both directions.
+                // only open border edges show up once, and those vertices are locked anyway
+                if (pa == pb || locked[pa]) {
+                    continue;
+                }
+                Quadric merged = quadrics[pa];
+                merged += quadrics[pb];
+                collapses.push_back({a, b, evaluate(merged, positions[pb])});
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {
+            return x.cost < y.cost;
+        });
+
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::fill(touched.begin(), touched.end(), 0);
+        const std::size_t triangles_to_remove = (result.size() - target_index_count + 2) / 3;
+        std::size_t removed = 0;
+        std::size_t collapsed = 0;
+
+        for (const Collapse& collapse: collapses) {
+            if (removed >= triangles_to_remove || collapse.cost > max_cost) {
+                break;
+            }
+            const std::uint32_t from = position_of[collapse.from];
+            const std::uint32_t to = position_of[collapse.to];
+            if (touched[from] || touched[to]) {
+                continue;
+            }
+
+            bool flips = false;
+            std::size_t removes = 0;
+            for (std::uint32_t a = offsets[from]; a < offsets[from + 1] && !flips; ++a) {
+                const std::size_t t = adjacency[a];
+                std::uint32_t corner[3];
+                for (int k = 0; k < 3; ++k) {
+                    corner[k] = position_of[result[t * 3 + k]];
+                }
+                if (corner[0] == to || corner[1] == to || corner[2] == to) {
+                    ++removes;
+                    continue;
+                }
+                glm::vec3 moved[3];
+                for (int k = 0; k < 3; ++k) {
+                    moved[k] = corner[k] == from ? positions[to] : positions[corner[k]];
+                }
+                const glm::vec3 before = glm::cross(positions[corner[1]] - positions[corner[0]],
+                                                    positions[corner[2]] - positions[corner[0]]);
+                const glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                flips = glm::dot(before, after) <= 0.0f;
+            }
+            if (flips) {
+                continue;
+            }
+
+            // from isn't on a seam, so it is this one vertex
+            remap[collapse.from] = collapse.to;
+            quadrics[to] += quadrics[from];
+            worst_cost = std::max(worst_cost, collapse.cost);
+            // the whole ring around `from` changes, keep this pass's other collapses out of it
+            for (std::uint32_t a = offsets[from]; a < offsets[from + 1]; ++a) {
+                const std::size_t t = adjacency[a];
+                for (int k = 0; k < 3; ++k) {
+                    touched[position_of[result[t * 3 + k]]] = 1;
+                }
+            }
+            removed += removes;
+            ++collapsed;
+        }
+        if (collapsed == 0) {
+            break;
+        }
+
+        std::size_t write = 0;
+        for (std::size_t t = 0; t < triangle_count; ++t) {
+            const std::uint32_t a = remap[result[t * 3]];
+            const std::uint32_t b = remap[result[t * 3 + 1]];
+            const std::uint32_t c = remap[result[t * 3 + 2]];
+            const std::uint32_t pa = position_of[a], pb = position_of[b], pc = position_of[c];
+            if (pa == pb || pb == pc || pa == pc) {
+                continue;
+            }
+            result[write++] = a;
+            result[write++] = b;
+            result[write++] = c;
+        }
+        result.resize(write);
+    }
+
+    if (result_error) {
+        *result_error = static_cast<float>(std::sqrt(worst_cost));
+    }
+    return result;
+}
+
+std::vector<LodLevel> build_lod_chain(const Mesh& mesh, int max_levels, float reduction) {
+    std::vector<LodLevel> levels;
+    levels.push_back({mesh.indices, mesh.sub_meshes, 0.0f});
+
+    std::vector<SubMesh> ranges = mesh.sub_meshes;
+    if (ranges.empty()) {
+        ranges.push_back({0, static_cast<std::uint32_t>(mesh.indices.size())});
+    }
+
+    // always from the full mesh, so the error is against the original and doesn't pile up level by level
+    float ratio = 1.0f;
+    for (int level_index = 1; level_index < max_levels; ++level_index) {
+        ratio *= reduction;
+        LodLevel level{{}, {}, 0.0f};
+        for (const SubMesh& range: ranges) {
+            std::span<const std::uint32_t> source(mesh.indices.data() + range.index_offset, range.index_count);
+            const auto target = static_cast<std::size_t>(static_cast<float>(range.index_count / 3) * ratio) * 3;
+            float error = 0.0f;
+            std::vector<std::uint32_t> simplified = simplify(source, mesh.vertices, target, 1e30f, &error);
+            optimize_vertex_cache(simplified, mesh.vertices.size());
+
+            if (!mesh.sub_meshes.empty()) {
+                level.sub_meshes.push_back({static_cast<std::uint32_t>(level.indices.size()),
+                                            static_cast<std::uint32_t>(simplified.size())});
+            }
+            level.indices.insert(level.indices.end(), simplified.begin(), simplified.end());
+            level.error = std::max(level.error, error);
+        }
+
+        // locked seams and borders can stop the simplifier well short of the target
+        if (level.indices.size() * 10 > levels.back().indices.size() * 9) {
+            break;
+        }
+        levels.push_back(std::move(level));
+    }
+    return levels;
+}
+
+LodChain add_lod_chain(GeometryPool& pool, const Mesh& mesh, int max_levels, float reduction) {
+    LodChain chain;
+    const std::vector<LodLevel> levels = build_lod_chain(mesh, max_levels, reduction);
+    const int base = pool.add(mesh);
+    if (base < 0) {
+        return chain;
+    }
+    chain.handles.push_back(base);
+    chain.errors.push_back(0.0f);
+    for (std::size_t l = 1; l < levels.size(); ++l) {
+        chain.handles.push_back(pool.add_indices(base, levels[l].indices.data(), levels[l].indices.size()));
+        chain.errors.push_back(levels[l].error);
+    }
+    return chain;
+}
+
+float pixels_per_unit(const glm::mat4& projection, float viewport_height, float distance) {
+    // projection[1][1] is cot(fov / 2): a unit at distance 1 spans that much of half the viewport
+    return projection[1][1] * viewport_height * 0.5f / std::max(distance, 1e-6f);
+}
+
+int select_lod(std::span<const float> errors, float pixels_per_unit, int current, float pixel_threshold,
+               float hysteresis) {
+    if (errors.empty()) {
+        return 0;
+    }
+    const int last = static_cast<int>(errors.size()) - 1;
+    int level = std::clamp(current, 0, last);
+
+    if (errors[level] * pixels_per_unit > pixel_threshold * (1.0f + hysteresis)) {
+        while (level > 0 && errors[level] * pixels_per_unit > pixel_threshold) {
+            --level;
+        }
+        return level;
+    }
+    while (level < last && errors[level + 1] * pixels_per_unit <= pixel_threshold * (1.0f - hysteresis)) {
+        ++level;
+    }
+    return level;
+}
+
+} // tools
@@ -0,0 +1,70 @@
+#include "tools/mapped_file.h"
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace tools {
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        std::cerr << "ERROR::MAPPED_FILE::FAILED_TO_OPEN: " << path << std::endl;
+        return;
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapped = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            // we read front to back, let the kernel read ahead aggressively
+            madvise(mapped, static_cast<std::size_t>(info.st_size), MADV_SEQUENTIAL);
+            _data = static_cast<const char*>(mapped);
+            _size = static_cast<std::size_t>(info.st_size);
+        } else {
+            std::cerr << "ERROR::MAPPED_FILE::FAILED_TO_MAP: " << path << std::endl;
+        }
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+        : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0)) {
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+    }
+    return *this;
+}
+
+bool MappedFile::valid() const {
+    return _data != nullptr;
+}
+
+const char* MappedFile::data() const {
+    return _data;
+}
+
+std::size_t MappedFile::size() const {
+    return _size;
+}
+
+void MappedFile::unmap() {
+    if (_data != nullptr) {
+        munmap(const_cast<char*>(_data), _size);
+        _data = nullptr;
+        _size = 0;
+    }
+}
+
+} // tools
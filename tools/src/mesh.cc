@@ -0,0 +1,751 @@
+#include "tools/mesh.h"
+#include "tools/mapped_file.h"
+#include "json.hh"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace tools {
+
+bool Mesh::fits_16bit_indices() const {
+    return vertices.size() <= std::numeric_limits<std::uint16_t>::max() + 1ull;
+}
+
+std::vector<std::uint8_t> Mesh::packed_indices(GLenum& index_type) const {
+    std::vector<std::uint8_t> packed;
+    if (fits_16bit_indices()) {
+        index_type = GL_UNSIGNED_SHORT;
+        packed.resize(indices.size() * sizeof(std::uint16_t));
+        auto* out = reinterpret_cast<std::uint16_t*>(packed.data());
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            out[i] = static_cast<std::uint16_t>(indices[i]);
+        }
+    } else {
+        index_type = GL_UNSIGNED_INT;
+        packed.resize(indices.size() * sizeof(std::uint32_t));
+        std::memcpy(packed.data(), indices.data(), packed.size());
+    }
+    return packed;
+}
+
+namespace {
+
+bool ends_with(const std::string& text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void skip_spaces(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+        ++p;
+    }
+}
+
+void skip_line(const char*& p, const char* end) {
+    const void* newline = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+    p = newline ? static_cast<const char*>(newline) + 1 : end;
+}
+
+float parse_float(const char*& p, const char* end) {
+    skip_spaces(p, end);
+    if (p < end && *p == '+') {
+        ++p;
+    }
+    float value = 0.0f;
+    p = std::from_chars(p, end, value).ptr;
+    return value;
+}
+
+bool parse_int(const char*& p, const char* end, int& value) {
+    const auto [next, error] = std::from_chars(p, end, value);
+    if (error != std::errc()) {
+        return false;
+    }
+    p = next;
+    return true;
+}
+
+struct ObjCorner {
+    int position;
+    int uv;
+    int normal;
+};
+
+/**
+ * Open addressing map from v/vt/vn triples to vertex indices.
+ * std::unordered_map allocates a node per vertex, which dominates on multi million vertex files.
+ */
+class CornerMap {
+public:
+    explicit CornerMap(std::size_t expected) {
+        std::size_t capacity = 64;
+        while (capacity < expected * 2) {
+            capacity *= 2;
+        }
+        _slots.assign(capacity, Slot{{-1, -1, -1}, 0});
+    }
+
+    /**
+     * @return the existing index, or `next_index` after inserting it
+     */
+    std::uint32_t find_or_insert(const ObjCorner& corner, std::uint32_t next_index, bool& inserted) {
+        if ((_size + 1) * 2 > _slots.size()) {
+            grow();
+        }
+
+        std::size_t slot = hash(corner) & (_slots.size() - 1);
+        while (true) {
+            Slot& current = _slots[slot];
+            if (current.corner.position == -1) {
+                current = {corner, next_index};
+                ++_size;
+                inserted = true;
+                return next_index;
+            }
+            if (current.corner.position == corner.position && current.corner.uv == corner.uv &&
+                current.corner.normal == corner.normal) {
+                inserted = false;
+                return current.index;
+            }
+            slot = (slot + 1) & (_slots.size() - 1);
+        }
+    }
+
+private:
+    struct Slot {
+        ObjCorner corner;
+        std::uint32_t index;
+    };
+
+    static std::size_t hash(const ObjCorner& corner) {
+        std::uint64_t h = static_cast<std::uint32_t>(corner.position) * 0x9E3779B97F4A7C15ull;
+        h ^= static_cast<std::uint32_t>(corner.uv) * 0xC2B2AE3D27D4EB4Full;
+        h ^= static_cast<std::uint32_t>(corner.normal) * 0x165667B19E3779F9ull;
+        return static_cast<std::size_t>(h ^ (h >> 29));
+    }
+
+    void grow() {
+        std::vector<Slot> old = std::move(_slots);
+        _slots.assign(old.size() * 2, Slot{{-1, -1, -1}, 0});
+        _size = 0;
+        bool inserted;
+        for (const Slot& slot: old) {
+            if (slot.corner.position != -1) {
+                find_or_insert(slot.corner, slot.index, inserted);
+            }
+        }
+    }
+
+    std::vector<Slot> _slots;
+    std::size_t _size = 0;
+};
+
+// obj indices are 1 based, negative ones count back from the end
+int resolve_obj_index(int index, std::size_t count) {
+    if (index > 0) {
+        return index - 1;
+    }
+    if (index < 0) {
+        return static_cast<int>(count) + index;
+    }
+    return -1;
+}
+
+void close_sub_mesh(Mesh& mesh, std::uint32_t& start) {
+    const auto end = static_cast<std::uint32_t>(mesh.indices.size());
+    if (end > start) {
+        mesh.sub_meshes.push_back({start, end - start});
+    }
+    start = end;
+}
+
+} // namespace
+
+bool load_obj(const std::string& path, Mesh& out) {
+    MappedFile file(path);
+    if (!file.valid()) {
+        return false;
+    }
+
+    const char* p = file.data();
+    const char* end = p + file.size();
+
+    // rough guess from typical line lengths, saves most of the regrowing
+    const std::size_t expected = file.size() / 64;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    positions.reserve(expected);
+    out.vertices.clear();
+    out.indices.clear();
+    out.sub_meshes.clear();
+    out.vertices.reserve(expected);
+    out.indices.reserve(expected * 3);
+
+    CornerMap corners(expected);
+    std::uint32_t sub_mesh_start = 0;
+    std::vector<std::uint32_t> face;
+
+    while (p < end) {
+        skip_spaces(p, end);
+        if (p >= end) {
+            break;
+        }
+
+        if (p[0] == 'v' && p + 1 < end && (p[1] == ' ' || p[1] == '\t')) {
+            p += 1;
+            glm::vec3 position;
+            position.x = parse_float(p, end);
+            position.y = parse_float(p, end);
+            position.z = parse_float(p, end);
+            positions.push_back(position);
+        } else if (p[0] == 'v' && p + 2 < end && p[1] == 't') {
+            p += 2;
+            glm::vec2 uv;
+            uv.x = parse_float(p, end);
+            uv.y = parse_float(p, end);
+            uvs.push_back(uv);
+        } else if (p[0] == 'v' && p + 2 < end && p[1] == 'n') {
+            p += 2;
+            glm::vec3 normal;
+            normal.x = parse_float(p, end);
+            normal.y = parse_float(p, end);
+            normal.z = parse_float(p, end);
+            normals.push_back(normal);
+        } else if (p[0] == 'f' && p + 1 < end && (p[1] == ' ' || p[1] == '\t')) {
+            p += 1;
+            face.clear();
+            while (true) {
+                skip_spaces(p, end);
+                int position_index = 0;
+                if (p >= end || *p == '\n' || !parse_int(p, end, position_index)) {
+                    break;
+                }
+
+                ObjCorner corner{resolve_obj_index(position_index, positions.size()), -1, -1};
+                if (p < end && *p == '/') {
+                    ++p;
+                    int index = 0;
+                    if (p < end && *p != '/' && parse_int(p, end, index)) {
+                        corner.uv = resolve_obj_index(index, uvs.size());
+                    }
+                    if (p < end && *p == '/') {
+                        ++p;
+                        if (parse_int(p, end, index)) {
+                            corner.normal = resolve_obj_index(index, normals.size());
+                        }
+                    }
+                }
+
+                if (corner.position < 0 || corner.position >= static_cast<int>(positions.size())) {
+                    std::cerr << "ERROR::MESH::OBJ_INDEX_OUT_OF_RANGE: " << path << std::endl;
+                    return false;
+                }
+
+                bool inserted;
+                const auto next_index = static_cast<std::uint32_t>(out.vertices.size());
+                const std::uint32_t index = corners.find_or_insert(corner, next_index, inserted);
+                if (inserted) {
+                    Vertex vertex{positions[static_cast<std::size_t>(corner.position)], glm::vec3(0.0f), glm::vec2(0.0f)};
+                    if (corner.uv >= 0 && corner.uv < static_cast<int>(uvs.size())) {
+                        vertex.uv = uvs[static_cast<std::size_t>(corner.uv)];
+                    }
+                    if (corner.normal >= 0 && corner.normal < static_cast<int>(normals.size())) {
+                        vertex.normal = normals[static_cast<std::size_t>(corner.normal)];
+                    }
+                    out.vertices.push_back(vertex);
+                }
+                face.push_back(index);
+            }
+
+            for (std::size_t i = 2; i < face.size(); ++i) {
+                out.indices.push_back(face[0]);
+                out.indices.push_back(face[i - 1]);
+                out.indices.push_back(face[i]);
+            }
+        } else if (p[0] == 'o' || p[0] == 'g' || (end - p > 6 && std::memcmp(p, "usemtl", 6) == 0)) {
+            close_sub_mesh(out, sub_mesh_start);
+        }
+
+        skip_line(p, end);
+    }
+
+    close_sub_mesh(out, sub_mesh_start);
+    return true;
+}
+
+namespace {
+
+struct GltfBuffers {
+    std::vector<MappedFile> files; // keeps the mappings alive
+    std::vector<std::pair<const char*, std::size_t>> views;
+};
+
+int component_count(const std::string& type) {
+    if (type == "SCALAR") {
+        return 1;
+    }
+    if (type == "VEC2") {
+        return 2;
+    }
+    if (type == "VEC3") {
+        return 3;
+    }
+    return type == "VEC4" ? 4 : 0;
+}
+
+/**
+ * @return 0 for a component type glTF doesn't have
+ */
+int component_bytes(long long component_type) {
+    switch (component_type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+            return 2;
+        case GL_UNSIGNED_INT:
+        case GL_FLOAT:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * A view over one accessor inside the mapped buffer, nothing is copied until read.
+ */
+struct Accessor {
+    const char* data = nullptr;
+    std::size_t count = 0;
+    std::size_t stride = 0;
+    long long component_type = GL_FLOAT;
+    int components = 0;
+    bool normalized = false;
+
+    /**
+     * what read_float decodes: floats and (normalized or not) 8 and 16 bit integers
+     */
+    bool float_readable() const {
+        return component_type != GL_UNSIGNED_INT;
+    }
+
+    /**
+     * what read_index decodes
+     */
+    bool index_readable() const {
+        return components == 1 && (component_type == GL_UNSIGNED_BYTE || component_type == GL_UNSIGNED_SHORT ||
+                                   component_type == GL_UNSIGNED_INT);
+    }
+
+    float read_float(std::size_t element, int component) const {
+        const char* at = data + element * stride + static_cast<std::size_t>(component * component_bytes(component_type));
+        switch (component_type) {
+            case GL_BYTE: {
+                const auto value = static_cast<signed char>(*at);
+                return normalized ? std::max(static_cast<float>(value) / 127.0f, -1.0f) : static_cast<float>(value);
+            }
+            case GL_SHORT: {
+                std::int16_t value;
+                std::memcpy(&value, at, sizeof(value));
+                return normalized ? std::max(static_cast<float>(value) / 32767.0f, -1.0f) : static_cast<float>(value);
+            }
+            case GL_UNSIGNED_BYTE: {
+                const auto value = static_cast<unsigned char>(*at);
+                return normalized ? static_cast<float>(value) / 255.0f : static_cast<float>(value);
+            }
+            case GL_UNSIGNED_SHORT: {
+                std::uint16_t value;
+                std::memcpy(&value, at, sizeof(value));
+                return normalized ? static_cast<float>(value) / 65535.0f : static_cast<float>(value);
+            }
+            default: {
+                float value;
+                std::memcpy(&value, at, sizeof(value));
+                return value;
+            }
+        }
+    }
+
+    std::uint32_t read_index(std::size_t element) const {
+        const char* at = data + element * stride;
+        switch (component_type) {
+            case GL_UNSIGNED_BYTE:
+                return static_cast<unsigned char>(*at);
+            case GL_UNSIGNED_SHORT: {
+                std::uint16_t value;
+                std::memcpy(&value, at, sizeof(value));
+                return value;
+            }
+            default: {
+                std::uint32_t value;
+                std::memcpy(&value, at, sizeof(value));
+                return value;
+            }
+        }
+    }
+};
+
+bool resolve_accessor(const json::Value& document, const GltfBuffers& buffers, long long index, Accessor& out) {
+    const json::Value& accessor = document["accessors"][static_cast<std::size_t>(index)];
+    const json::Value& view = document["bufferViews"][static_cast<std::size_t>(accessor["bufferView"].as_int(-1))];
+    const auto buffer = static_cast<std::size_t>(view["buffer"].as_int(-1));
+    if (accessor.type != json::Value::Type::object || view.type != json::Value::Type::object ||
+        buffer >= buffers.views.size() || accessor.has("sparse")) {
+        return false;
+    }
+
+    const long long count = accessor["count"].as_int();
+    out.component_type = accessor["componentType"].as_int(GL_FLOAT);
+    out.components = component_count(accessor["type"].string);
+    out.normalized = accessor["normalized"].boolean;
+    const int element_bytes = out.components * component_bytes(out.component_type);
+    const long long stride = view["byteStride"].as_int(element_bytes);
+    const long long view_offset = view["byteOffset"].as_int();
+    const long long accessor_offset = accessor["byteOffset"].as_int();
+    // all of it comes from the file: nothing negative, and elements may not overlap
+    if (count <= 0 || element_bytes == 0 || stride < element_bytes || view_offset < 0 || accessor_offset < 0) {
+        return false;
+    }
+    out.count = static_cast<std::size_t>(count);
+    out.stride = static_cast<std::size_t>(stride);
+
+    // each below 2^63, so the sum can't wrap. the range check is arranged so none of its terms can either
+    const std::size_t offset = static_cast<std::size_t>(view_offset) + static_cast<std::size_t>(accessor_offset);
+    const auto bytes = static_cast<std::size_t>(element_bytes);
+    const auto& [data, size] = buffers.views[buffer];
+    if (offset > size || bytes > size - offset || out.count - 1 > (size - offset - bytes) / out.stride) {
+        return false;
+    }
+    out.data = data + offset;
+    return true;
+}
+
+bool append_primitive(const json::Value& document, const GltfBuffers& buffers, const json::Value& primitive,
+                      Mesh& out) {
+    if (primitive["mode"].as_int(4) != 4) {
+        return true; // not triangles, skipped
+    }
+
+    const json::Value& attributes = primitive["attributes"];
+    Accessor positions;
+    if (!resolve_accessor(document, buffers, attributes["POSITION"].as_int(-1), positions) ||
+        positions.components != 3 || !positions.float_readable()) {
+        return false;
+    }
+
+    // read with a fixed component count, one that doesn't have it is skipped like a missing one
+    Accessor normals;
+    Accessor uvs;
+    const bool has_normals = resolve_accessor(document, buffers, attributes["NORMAL"].as_int(-1), normals) &&
+                             normals.count == positions.count && normals.components == 3 && normals.float_readable();
+    const bool has_uvs = resolve_accessor(document, buffers, attributes["TEXCOORD_0"].as_int(-1), uvs) &&
+                         uvs.count == positions.count && uvs.components == 2 && uvs.float_readable();
+
+    const auto base = static_cast<std::uint32_t>(out.vertices.size());
+    out.vertices.reserve(out.vertices.size() + positions.count);
+    for (std::size_t i = 0; i < positions.count; ++i) {
+        Vertex vertex{glm::vec3(positions.read_float(i, 0), positions.read_float(i, 1), positions.read_float(i, 2)),
+                      glm::vec3(0.0f), glm::vec2(0.0f)};
+        if (has_normals) {
+            vertex.normal = glm::vec3(normals.read_float(i, 0), normals.read_float(i, 1), normals.read_float(i, 2));
+        }
+        if (has_uvs) {
+            vertex.uv = glm::vec2(uvs.read_float(i, 0), uvs.read_float(i, 1));
+        }
+        out.vertices.push_back(vertex);
+    }
+
+    const auto index_offset = static_cast<std::uint32_t>(out.indices.size());
+    Accessor indices;
+    if (primitive.has("indices")) {
+        if (!resolve_accessor(document, buffers, primitive["indices"].as_int(-1), indices) ||
+            !indices.index_readable()) {
+            return false;
+        }
+        out.indices.reserve(out.indices.size() + indices.count);
+        for (std::size_t i = 0; i < indices.count; ++i) {
+            // everything downstream (optimizer, pool, the GPU) indexes the vertices without checking
+            const std::uint32_t index = indices.read_index(i);
+            if (index >= positions.count) {
+                return false;
+            }
+            out.indices.push_back(base + index);
+        }
+    } else {
+        for (std::size_t i = 0; i < positions.count; ++i) {
+            out.indices.push_back(base + static_cast<std::uint32_t>(i));
+        }
+    }
+
+    out.sub_meshes.push_back({index_offset, static_cast<std::uint32_t>(out.indices.size()) - index_offset});
+    return true;
+}
+
+} // namespace
+
+bool load_gltf(const std::string& path, Mesh& out) {
+    MappedFile file(path);
+    if (!file.valid()) {
+        return false;
+    }
+
+    GltfBuffers buffers;
+    std::string_view json_text(file.data(), file.size());
+    std::pair<const char*, std::size_t> glb_binary{nullptr, 0};
+
+    if (ends_with(path, ".glb")) {
+        // 12 byte header, then a JSON chunk and an optional BIN chunk
+        std::uint32_t header[3];
+        std::uint32_t chunk[2];
+        if (file.size() < 20) {
+            std::cerr << "ERROR::MESH::INVALID_GLB: " << path << std::endl;
+            return false;
+        }
+        std::memcpy(header, file.data(), sizeof(header));
+        std::memcpy(chunk, file.data() + 12, sizeof(chunk));
+        // lengths added in size_t, in uint32_t one near 4 GiB wraps around and passes the check
+        if (header[0] != 0x46546C67u || header[1] != 2 || chunk[1] != 0x4E4F534Au ||
+            20 + std::size_t{chunk[0]} > file.size()) {
+            std::cerr << "ERROR::MESH::INVALID_GLB: " << path << std::endl;
+            return false;
+        }
+        json_text = std::string_view(file.data() + 20, chunk[0]);
+
+        const std::size_t binary_offset = 20 + std::size_t{chunk[0]};
+        if (binary_offset + 8 <= file.size()) {
+            std::memcpy(chunk, file.data() + binary_offset, sizeof(chunk));
+            if (chunk[1] == 0x004E4942u && binary_offset + 8 + chunk[0] <= file.size()) {
+                glb_binary = {file.data() + binary_offset + 8, chunk[0]};
+            }
+        }
+    }
+
+    json::Value document;
+    if (!json::parse(json_text, document)) {
+        std::cerr << "ERROR::MESH::INVALID_GLTF_JSON: " << path << std::endl;
+        return false;
+    }
+
+    const std::string directory = path.substr(0, path.find_last_of('/') + 1);
+    const json::Value& buffer_list = document["buffers"];
+    buffers.files.reserve(buffer_list.size());
+    for (std::size_t i = 0; i < buffer_list.size(); ++i) {
+        const json::Value& buffer = buffer_list[i];
+        if (!buffer.has("uri")) {
+            buffers.views.push_back(glb_binary);
+            continue;
+        }
+        if (buffer["uri"].string.rfind("data:", 0) == 0) {
+            std::cerr << "ERROR::MESH::GLTF_DATA_URI_NOT_SUPPORTED: " << path << std::endl;
+            return false;
+        }
+        buffers.files.emplace_back(directory + buffer["uri"].string);
+        if (!buffers.files.back().valid()) {
+            return false;
+        }
+        buffers.views.emplace_back(buffers.files.back().data(), buffers.files.back().size());
+    }
+
+    out.vertices.clear();
+    out.indices.clear();
+    out.sub_meshes.clear();
+
+    const json::Value& meshes = document["meshes"];
+    for (std::size_t m = 0; m < meshes.size(); ++m) {
+        const json::Value& primitives = meshes[m]["primitives"];
+        for (std::size_t p = 0; p < primitives.size(); ++p) {
+            if (!append_primitive(document, buffers, primitives[p], out)) {
+                std::cerr << "ERROR::MESH::INVALID_GLTF_PRIMITIVE: " << path << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool load_mesh(const std::string& path, Mesh& out) {
+    if (ends_with(path, ".obj")) {
+        return load_obj(path, out);
+    }
+    if (ends_with(path, ".gltf") || ends_with(path, ".glb")) {
+        return load_gltf(path, out);
+    }
+    std::cerr << "ERROR::MESH::UNKNOWN_FORMAT: " << path << std::endl;
+    return false;
+}
+
+bool load_meshes(const std::vector<std::string>& paths, std::vector<Mesh>& out, JobSystem& jobs) {
+    out.assign(paths.size(), Mesh{});
+    std::atomic<bool> loaded{true};
+    jobs.parallel_for(0, paths.size(), 1, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+            if (!load_mesh(paths[i], out[i])) {
+                out[i] = Mesh{};
+                loaded = false;
+            }
+        }
+    });
+    return loaded.load();
+}
+
+VertexLayout vertex_layout(VertexFormat format) {
+    if (format == VertexFormat::compact) {
+        return VertexLayout()
+                .add(0, 3, GL_HALF_FLOAT).pad(2)
+                .add(1, 2, GL_SHORT, true)
+                .add(2, 2, GL_HALF_FLOAT);
+    }
+    return VertexLayout()
+            .add(0, 3, GL_FLOAT)
+            .add(1, 3, GL_FLOAT)
+            .add(2, 2, GL_FLOAT);
+}
+
+std::uint16_t float_to_half(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const std::uint32_t sign = (bits >> 16) & 0x8000u;
+    const std::uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+    if (magnitude >= 0x7F800000u) {
+        // inf stays inf, nan stays a (quiet) nan
+        return static_cast<std::uint16_t>(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+    }
+    if (magnitude >= 0x477FF000u) {
+        return static_cast<std::uint16_t>(sign | 0x7C00u); // rounds past 65504
+    }
+    if (magnitude < 0x38800000u) {
+        // subnormal half, let the float unit do the rounding
+        float absolute;
+        std::memcpy(&absolute, &magnitude, sizeof(absolute));
+        return static_cast<std::uint16_t>(sign | static_cast<std::uint32_t>(std::lround(absolute * 16777216.0f)));
+    }
+
+    // rebias the exponent and round the mantissa to nearest even
+    const std::uint32_t rounded = magnitude - 0x38000000u + 0xFFFu + ((magnitude >> 13) & 1u);
+    return static_cast<std::uint16_t>(sign | (rounded >> 13));
+}
+
+float half_to_float(std::uint16_t value) {
+    const std::uint32_t sign = static_cast<std::uint32_t>(value & 0x8000u) << 16;
+    const std::uint32_t exponent = (value >> 10) & 0x1Fu;
+    const std::uint32_t mantissa = value & 0x3FFu;
+
+    std::uint32_t bits;
+    if (exponent == 0) {
+        const float subnormal = static_cast<float>(mantissa) / 16777216.0f;
+        std::memcpy(&bits, &subnormal, sizeof(bits));
+        bits |= sign;
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+void encode_octahedral(const glm::vec3& normal, std::int16_t* out) {
+    const float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (sum == 0.0f) {
+        out[0] = 0;
+        out[1] = 0;
+        return;
+    }
+
+    float x = normal.x / sum;
+    float y = normal.y / sum;
+    if (normal.z < 0.0f) {
+        // fold the lower hemisphere over the diagonals
+        const float folded_x = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        const float folded_y = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = folded_x;
+        y = folded_y;
+    }
+    out[0] = static_cast<std::int16_t>(std::lround(std::clamp(x, -1.0f, 1.0f) * 32767.0f));
+    out[1] = static_cast<std::int16_t>(std::lround(std::clamp(y, -1.0f, 1.0f) * 32767.0f));
+}
+
+glm::vec3 decode_octahedral(const std::int16_t* encoded) {
+    const float x = std::max(static_cast<float>(encoded[0]) / 32767.0f, -1.0f);
+    const float y = std::max(static_cast<float>(encoded[1]) / 32767.0f, -1.0f);
+    glm::vec3 normal(x, y, 1.0f - std::abs(x) - std::abs(y));
+    if (normal.z < 0.0f) {
+        normal.x = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        normal.y = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return glm::normalize(normal);
+}
+
+std::vector<CompactVertex> quantize_vertices(const std::vector<Vertex>& vertices) {
+    std::vector<CompactVertex> compact(vertices.size());
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const Vertex& vertex = vertices[i];
+        CompactVertex& out = compact[i];
+        out.position[0] = float_to_half(vertex.position.x);
+        out.position[1] = float_to_half(vertex.position.y);
+        out.position[2] = float_to_half(vertex.position.z);
+        out.position[3] = float_to_half(1.0f);
+        encode_octahedral(vertex.normal, out.normal);
+        out.uv[0] = float_to_half(vertex.uv.x);
+        out.uv[1] = float_to_half(vertex.uv.y);
+    }
+    return compact;
+}
+
+MeshBuffers::MeshBuffers(const Mesh& mesh, VertexFormat format) {
+    const std::vector<std::uint8_t> indices = mesh.packed_indices(_index_type);
+    _index_count = static_cast<GLsizei>(mesh.indices.size());
+
+    glGenVertexArrays(1, &_vao);
+    glGenBuffers(1, &_vbo);
+    glGenBuffers(1, &_ebo);
+
+    glBindVertexArray(_vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    if (format == VertexFormat::compact) {
+        const std::vector<CompactVertex> compact = quantize_vertices(mesh.vertices);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(compact.size() * sizeof(CompactVertex)),
+                     compact.data(), GL_STATIC_DRAW);
+    } else {
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.vertices.size() * sizeof(Vertex)),
+                     mesh.vertices.data(), GL_STATIC_DRAW);
+    }
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size()), indices.data(), GL_STATIC_DRAW);
+
+    vertex_layout(format).apply();
+
+    glBindVertexArray(0);
+}
+
+MeshBuffers::~MeshBuffers() {
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteBuffers(1, &_vbo);
+    glDeleteBuffers(1, &_ebo);
+}
+
+void MeshBuffers::draw() const {
+    glBindVertexArray(_vao);
+    glDrawElements(GL_TRIANGLES, _index_count, _index_type, nullptr);
+}
+
+void MeshBuffers::draw(const SubMesh& sub_mesh) const {
+    const std::size_t index_bytes = _index_type == GL_UNSIGNED_SHORT ? 2 : 4;
+    glBindVertexArray(_vao);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(sub_mesh.index_count), _index_type,
+                   (void*) (sub_mesh.index_offset * index_bytes));
+}
+
+} // tools
@@ -0,0 +1,307 @@
+#include "tools/mesh_optimizer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace tools {
+
+namespace {
+
+// the values from Forsyth's paper, tuned for a 32 entry LRU model
+constexpr int cache_model_size = 32;
+constexpr float cache_decay_power = 1.5f;
+constexpr float last_triangle_score = 0.75f;
+constexpr float valence_boost_scale = 2.0f;
+constexpr float valence_boost_power = 0.5f;
+constexpr int valence_table_size = 32;
+
+class VertexScores {
+public:
+    VertexScores() {
+        for (int i = 0; i < cache_model_size; ++i) {
+            if (i < 3) {
+                // the triangle we just emitted, deliberately not the best so we don't walk in a fan forever
+                _cache[i] = last_triangle_score;
+            } else {
+                const float scale = 1.0f / static_cast<float>(cache_model_size - 3);
+                _cache[i] = std::pow(1.0f - static_cast<float>(i - 3) * scale, cache_decay_power);
+            }
+        }
+        _valence[0] = 0.0f;
+        for (int i = 1; i < valence_table_size; ++i) {
+            _valence[i] = valence_boost_scale * std::pow(static_cast<float>(i), -valence_boost_power);
+        }
+    }
+
+    float operator()(int cache_position, unsigned int remaining) const {
+        if (remaining == 0) {
+            return -1.0f;
+        }
+        // few triangles left means finishing this vertex off soon frees up a cache slot
+        float score = remaining < valence_table_size
+                      ? _valence[remaining]
+                      : valence_boost_scale * std::pow(static_cast<float>(remaining), -valence_boost_power);
+        if (cache_position >= 0) {
+            score += _cache[cache_position];
+        }
+        return score;
+    }
+
+private:
+    std::array<float, cache_model_size> _cache{};
+    std::array<float, valence_table_size> _valence{};
+};
+
+} // namespace
+
+void optimize_vertex_cache(std::span<std::uint32_t> indices, std::size_t vertex_count) {
+    const std::size_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0) {
+        return;
+    }
+    static const VertexScores score;
+
+    // triangles per vertex, as one flat array with per vertex offsets
+    std::vector<unsigned int> remaining(vertex_count, 0);
+    for (std::uint32_t index: indices) {
+        ++remaining[index];
+    }
+    std::vector<std::size_t> offsets(vertex_count + 1, 0);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        offsets[v + 1] = offsets[v] + remaining[v];
+    }
+    std::vector<std::uint32_t> adjacency(offsets[vertex_count]);
+    {
+        std::vector<std::size_t> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t t = 0; t < triangle_count; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<std::uint32_t>(t);
+            }
+        }
+    }
+
+    std::vector<float> vertex_scores(vertex_count);
+    std::vector<int> cache_position(vertex_count, -1);
+    for (std::size_t v = 0; v < vertex_count; ++v) {
+        vertex_scores[v] = score(-1, remaining[v]);
+    }
+
+    std::vector<float> triangle_scores(triangle_count);
+    std::vector<bool> emitted(triangle_count, false);
+    std::size_t best = 0;
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        triangle_scores[t] = vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] +
+                             vertex_scores[indices[t * 3 + 2]];
+        if (triangle_scores[t] > triangle_scores[best]) {
+            best = t;
+        }
+    }
+
+    std::vector<std::uint32_t> output;
+    output.reserve(indices.size());
+    std::array<std::uint32_t, cache_model_size + 3> cache{};
+    std::array<std::uint32_t, cache_model_size + 3> next_cache{};
+    std::size_t cache_count = 0;
+    std::size_t cursor = 0;
+    constexpr std::size_t none = std::numeric_limits<std::size_t>::max();
+
+    for (std::size_t emitted_count = 0; emitted_count < triangle_count; ++emitted_count) {
+        if (best == none) {
+            // nothing in the cache has triangles left, continue with the next one in input order
+            while (emitted[cursor]) {
+                ++cursor;
+            }
+            best = cursor;
+        }
+
+        const std::uint32_t triangle[3] = {indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2]};
+        output.insert(output.end(), triangle, triangle + 3);
+        emitted[best] = true;
+
+        for (std::uint32_t v: triangle) {
+            // swap-remove the triangle from the vertex's live range
+            const auto begin = adjacency.begin() + static_cast<long>(offsets[v]);
+            const auto end = begin + remaining[v];
+            const auto found = std::find(begin, end, static_cast<std::uint32_t>(best));
+            if (found != end) {
+                std::iter_swap(found, end - 1);
+                --remaining[v];
+            }
+        }
+
+        // the emitted triangle goes to the front, everything else shifts back
+        std::size_t next_count = 0;
+        for (std::uint32_t v: triangle) {
+            if (std::find(next_cache.begin(), next_cache.begin() + static_cast<long>(next_count), v) ==
+                next_cache.begin() + static_cast<long>(next_count)) {
+                next_cache[next_count++] = v;
+            }
+        }
+        for (std::size_t i = 0; i < cache_count; ++i) {
+            const std::uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                next_cache[next_count++] = v;
+            }
+        }
+
+        for (std::size_t i = 0; i < next_count; ++i) {
+            const std::uint32_t v = next_cache[i];
+            cache_position[v] = i < cache_model_size ? static_cast<int>(i) : -1;
+            const float updated = score(cache_position[v], remaining[v]);
+            const float delta = updated - vertex_scores[v];
+            vertex_scores[v] = updated;
+            for (std::size_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+                triangle_scores[adjacency[a]] += delta;
+            }
+        }
+
+        cache_count = std::min<std::size_t>(next_count, cache_model_size);
+        std::copy(next_cache.begin(), next_cache.begin() + static_cast<long>(cache_count), cache.begin());
+
+        best = none;
+        float best_score = -std::numeric_limits<float>::max();
+        for (std::size_t i = 0; i < cache_count; ++i) {
+            const std::uint32_t v = cache[i];
+            for (std::size_t a = offsets[v]; a < offsets[v] + remaining[v]; ++a) {
+                if (triangle_scores[adjacency[a]] > best_score) {
+                    best_score = triangle_scores[adjacency[a]];
+                    best = adjacency[a];
+                }
+            }
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimize_overdraw(std::span<std::uint32_t> indices, std::span<const Vertex> vertices) {
+    const std::size_t triangle_count = indices.size() / 3;
+    if (triangle_count < 2) {
+        return;
+    }
+
+    // clusters start wherever a triangle misses the cache with all three vertices
+    constexpr int fifo_size = 16;
+    std::vector<std::size_t> cluster_starts;
+    std::vector<std::uint32_t> fifo_time(vertices.size(), 0);
+    std::uint32_t time = fifo_size + 1;
+    for (std::size_t t = 0; t < triangle_count; ++t) {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k) {
+            const std::uint32_t v = indices[t * 3 + k];
+            if (time - fifo_time[v] > fifo_size) {
+                fifo_time[v] = time++;
+                ++misses;
+            }
+        }
+        if (misses == 3 || t == 0) {
+            cluster_starts.push_back(t);
+        }
+    }
+    cluster_starts.push_back(triangle_count);
+
+    glm::vec3 mesh_centre(0.0f);
+    for (std::uint32_t index: indices) {
+        mesh_centre += vertices[index].position;
+    }
+    mesh_centre = mesh_centre / static_cast<float>(indices.size());
+
+    struct Cluster {
+        std::size_t first;
+        std::size_t last;
+        float sort_key;
+    };
+    std::vector<Cluster> clusters;
+    clusters.reserve(cluster_starts.size() - 1);
+
+    for (std::size_t c = 0; c + 1 < cluster_starts.size(); ++c) {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+        for (std::size_t t = cluster_starts[c]; t < cluster_starts[c + 1]; ++t) {
+            const glm::vec3& a = vertices[indices[t * 3]].position;
+            const glm::vec3& b = vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& d = vertices[indices[t * 3 + 2]].position;
+            const glm::vec3 weighted_normal = glm::cross(b - a, d - a); // length is twice the area
+            const float triangle_area = glm::length(weighted_normal);
+            normal += weighted_normal;
+            centroid += (a + b + d) * (triangle_area / 3.0f);
+            area += triangle_area;
+        }
+
+        float key = 0.0f;
+        const float normal_length = glm::length(normal);
+        if (area > 0.0f && normal_length > 0.0f) {
+            centroid = centroid / area;
+            key = glm::dot(centroid - mesh_centre, normal / normal_length);
+        }
+        clusters.push_back({cluster_starts[c], cluster_starts[c + 1], key});
+    }
+
+    // the most outward facing first, they are the ones most likely to hide the rest
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sort_key > b.sort_key;
+    });
+
+    std::vector<std::uint32_t> output;
+    output.reserve(indices.size());
+    for (const Cluster& cluster: clusters) {
+        output.insert(output.end(), indices.begin() + static_cast<long>(cluster.first * 3),
+                      indices.begin() + static_cast<long>(cluster.last * 3));
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimize_vertex_fetch(Mesh& mesh) {
+    constexpr std::uint32_t unused = std::numeric_limits<std::uint32_t>::max();
+    std::vector<std::uint32_t> remap(mesh.vertices.size(), unused);
+    std::vector<Vertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+
+    for (std::uint32_t& index: mesh.indices) {
+        if (remap[index] == unused) {
+            remap[index] = static_cast<std::uint32_t>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+float average_cache_miss_ratio(std::span<const std::uint32_t> indices, std::size_t vertex_count, int cache_size) {
+    if (indices.size() < 3) {
+        return 0.0f;
+    }
+
+    // FIFO: a hit doesn't refresh the entry, so "in cache" is just "missed less than cache_size misses ago"
+    std::vector<std::uint32_t> miss_time(vertex_count, 0);
+    auto time = static_cast<std::uint32_t>(cache_size + 1);
+    std::size_t misses = 0;
+    for (std::uint32_t index: indices) {
+        if (time - miss_time[index] > static_cast<std::uint32_t>(cache_size)) {
+            miss_time[index] = time++;
+            ++misses;
+        }
+    }
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+void optimize_mesh(Mesh& mesh, bool overdraw) {
+    std::vector<SubMesh> ranges = mesh.sub_meshes;
+    if (ranges.empty()) {
+        ranges.push_back({0, static_cast<std::uint32_t>(mesh.indices.size())});
+    }
+
+    for (const SubMesh& range: ranges) {
+        std::span<std::uint32_t> indices(mesh.indices.data() + range.index_offset, range.index_count);
+        optimize_vertex_cache(indices, mesh.vertices.size());
+        if (overdraw) {
+            optimize_overdraw(indices, mesh.vertices);
+        }
+    }
+    optimize_vertex_fetch(mesh);
+}
+
+} // tools
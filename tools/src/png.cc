@@ -0,0 +1,342 @@
+#include "tools/png.h"
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace tools {
+
+namespace {
+
+constexpr int window_size = 1 << 15;
+constexpr int hash_bits = 15;
+constexpr int min_match = 3;
+constexpr int max_match = 258;
+constexpr int max_chain = 16;
+
+constexpr std::array<std::uint16_t, 29> length_base = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43,
+                                                       51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr std::array<std::uint8_t, 29> length_extra = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4,
+                                                       4, 4, 4, 5, 5, 5, 5, 0};
+constexpr std::array<std::uint16_t, 30> distance_base = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257,
+                                                         385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193,
+                                                         12289, 16385, 24577};
+constexpr std::array<std::uint8_t, 30> distance_extra = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9,
+                                                         9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+/**
+ * deflate packs bits from the least significant end, huffman codes go in most significant bit first
+ */
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<std::uint8_t>& out) : _out(out) {}
+
+    void write(std::uint32_t value, int count) {
+        _bits |= value << _count;
+        _count += count;
+        while (_count >= 8) {
+            _out.push_back(static_cast<std::uint8_t>(_bits));
+            _bits >>= 8;
+            _count -= 8;
+        }
+    }
+
+    void write_code(std::uint32_t code, int length) {
+        std::uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i) {
+            reversed |= ((code >> i) & 1u) << (length - 1 - i);
+        }
+        write(reversed, length);
+    }
+
+    void flush() {
+        if (_count > 0) {
+            _out.push_back(static_cast<std::uint8_t>(_bits));
+        }
+        _bits = 0;
+        _count = 0;
+    }
+
+private:
+    std::vector<std::uint8_t>& _out;
+    std::uint32_t _bits = 0;
+    int _count = 0;
+};
+
+/**
+ * the fixed literal/length code of RFC 1951 3.2.6
+ */
+void write_symbol(BitWriter& writer, int symbol) {
+    if (symbol <= 143) {
+        writer.write_code(0x30 + symbol, 8);
+    } else if (symbol <= 255) {
+        writer.write_code(0x190 + symbol - 144, 9);
+    } else if (symbol <= 279) {
+        writer.write_code(symbol - 256, 7);
+    } else {
+        writer.write_code(0xc0 + symbol - 280, 8);
+    }
+}
+
+void write_match(BitWriter& writer, int length, int distance) {
+    int code = static_cast<int>(length_base.size()) - 1;
+    while (length_base[code] > length) {
+        --code;
+    }
+    write_symbol(writer, 257 + code);
+    writer.write(length - length_base[code], length_extra[code]);
+
+    code = static_cast<int>(distance_base.size()) - 1;
+    while (distance_base[code] > distance) {
+        --code;
+    }
+    writer.write_code(code, 5);
+    writer.write(distance - distance_base[code], distance_extra[code]);
+}
+
+std::uint32_t hash3(const std::uint8_t* data) {
+    const std::uint32_t value = data[0] | (data[1] << 8) | (data[2] << 16);
+    return (value * 2654435761u) >> (32 - hash_bits);
+}
+
+/**
+ * one final fixed huffman block, greedy matches through a hash chain
+ */
+void deflate(const std::vector<std::uint8_t>& data, std::vector<std::uint8_t>& out) {
+    BitWriter writer(out);
+    writer.write(1, 1); // final block
+    writer.write(1, 2); // fixed huffman
+
+    std::vector<std::int32_t> head(1u << hash_bits, -1);
+    std::vector<std::int32_t> previous(window_size, -1);
+    const auto size = static_cast<std::int32_t>(data.size());
+
+    auto insert = [&](std::int32_t position) {
+        if (position + min_match > size) {
+            return;
+        }
+        const std::uint32_t hash = hash3(&data[position]);
+        previous[position & (window_size - 1)] = head[hash];
+        head[hash] = position;
+    };
+
+    std::int32_t position = 0;
+    while (position < size) {
+        int best_length = 0;
+        int best_distance = 0;
+        if (position + min_match <= size) {
+            const int limit = std::min(max_match, size - position);
+            std::int32_t candidate = head[hash3(&data[position])];
+            for (int chain = 0; chain < max_chain && candidate >= 0 && position - candidate <= window_size; ++chain) {
+                int length = 0;
+                while (length < limit && data[candidate + length] == data[position + length]) {
+                    ++length;
+                }
+                if (length > best_length) {
+                    best_length = length;
+                    best_distance = position - candidate;
+                    if (length == limit) {
+                        break;
+                    }
+                }
+                candidate = previous[candidate & (window_size - 1)];
+            }
+        }
+
+        if (best_length >= min_match) {
+            write_match(writer, best_length, best_distance);
+            for (int i = 0; i < best_length; ++i) {
+                insert(position + i);
+            }
+            position += best_length;
+        } else {
+            write_symbol(writer, data[position]);
+            insert(position);
+            ++position;
+        }
+    }
+    write_symbol(writer, 256);
+    writer.flush();
+}
+
+/**
+ * uncompressed blocks, for data that fixed huffman codes would make bigger (noise, photos)
+ */
+void store(const std::vector<std::uint8_t>& data, std::vector<std::uint8_t>& out) {
+    std::size_t offset = 0;
+    do {
+        const std::size_t size = std::min<std::size_t>(65535, data.size() - offset);
+        out.push_back(offset + size == data.size() ? 1 : 0); // final flag, stored type, padded to the byte
+        out.push_back(static_cast<std::uint8_t>(size));
+        out.push_back(static_cast<std::uint8_t>(size >> 8));
+        out.push_back(static_cast<std::uint8_t>(~size));
+        out.push_back(static_cast<std::uint8_t>(~size >> 8));
+        out.insert(out.end(), data.begin() + static_cast<std::ptrdiff_t>(offset),
+                   data.begin() + static_cast<std::ptrdiff_t>(offset + size));
+        offset += size;
+    } while (offset < data.size());
+}
+
+std::uint32_t adler32(const std::vector<std::uint8_t>& data) {
+    std::uint32_t a = 1;
+    std::uint32_t b = 0;
+    std::size_t i = 0;
+    while (i < data.size()) {
+        // 5552 bytes is as many as fit before b could overflow
+        const std::size_t end = std::min(data.size(), i + 5552);
+        for (; i < end; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+std::uint32_t crc32(const std::uint8_t* data, std::size_t size) {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> values{};
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            }
+            values[n] = c;
+        }
+        return values;
+    }();
+
+    std::uint32_t crc = 0xffffffffu;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+void put_u32(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    out.push_back(static_cast<std::uint8_t>(value >> 24));
+    out.push_back(static_cast<std::uint8_t>(value >> 16));
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void put_chunk(std::vector<std::uint8_t>& out, const char* type, const std::vector<std::uint8_t>& data) {
+    put_u32(out, static_cast<std::uint32_t>(data.size()));
+    const std::size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    put_u32(out, crc32(&out[start], out.size() - start));
+}
+
+int paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+/**
+ * filter byte + filtered row for every row. each row gets whichever of the five filters has the smallest
+ * sum of absolute (signed) values, the heuristic libpng uses too
+ */
+std::vector<std::uint8_t> filter_rows(const Image& image) {
+    const std::size_t stride = static_cast<std::size_t>(image.width) * image.channels;
+    const int bpp = image.channels;
+    std::vector<std::uint8_t> filtered;
+    filtered.reserve((stride + 1) * image.height);
+
+    std::vector<std::uint8_t> zero_row(stride, 0);
+    std::array<std::vector<std::uint8_t>, 5> candidates;
+    for (auto& candidate: candidates) {
+        candidate.resize(stride);
+    }
+
+    for (int y = 0; y < image.height; ++y) {
+        const std::uint8_t* row = &image.pixels[y * stride];
+        const std::uint8_t* above = y > 0 ? &image.pixels[(y - 1) * stride] : zero_row.data();
+        for (std::size_t i = 0; i < stride; ++i) {
+            const int left = i >= static_cast<std::size_t>(bpp) ? row[i - bpp] : 0;
+            const int up_left = i >= static_cast<std::size_t>(bpp) ? above[i - bpp] : 0;
+            candidates[0][i] = row[i];
+            candidates[1][i] = static_cast<std::uint8_t>(row[i] - left);
+            candidates[2][i] = static_cast<std::uint8_t>(row[i] - above[i]);
+            candidates[3][i] = static_cast<std::uint8_t>(row[i] - ((left + above[i]) >> 1));
+            candidates[4][i] = static_cast<std::uint8_t>(row[i] - paeth(left, above[i], up_left));
+        }
+
+        int best = 0;
+        long best_sum = -1;
+        for (int filter = 0; filter < 5; ++filter) {
+            long sum = 0;
+            for (std::uint8_t value: candidates[filter]) {
+                sum += std::abs(static_cast<std::int8_t>(value));
+            }
+            if (best_sum < 0 || sum < best_sum) {
+                best = filter;
+                best_sum = sum;
+            }
+        }
+        filtered.push_back(static_cast<std::uint8_t>(best));
+        filtered.insert(filtered.end(), candidates[best].begin(), candidates[best].end());
+    }
+    return filtered;
+}
+
+} // namespace
+
+std::vector<std::uint8_t> encode_png(const Image& image) {
+    static constexpr std::uint8_t colour_types[] = {0, 0, 4, 2, 6}; // by channel count: grey, grey + alpha, rgb, rgba
+    if (image.width <= 0 || image.height <= 0 || image.channels < 1 || image.channels > 4 ||
+        image.pixels.size() < static_cast<std::size_t>(image.width) * image.height * image.channels) {
+        std::cerr << "ERROR::PNG::UNSUPPORTED_IMAGE" << std::endl;
+        return {};
+    }
+
+    std::vector<std::uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+    std::vector<std::uint8_t> header;
+    put_u32(header, static_cast<std::uint32_t>(image.width));
+    put_u32(header, static_cast<std::uint32_t>(image.height));
+    header.push_back(8); // bits per channel
+    header.push_back(colour_types[image.channels]);
+    header.push_back(0); // deflate
+    header.push_back(0); // adaptive filtering
+    header.push_back(0); // no interlacing
+    put_chunk(png, "IHDR", header);
+
+    const std::vector<std::uint8_t> filtered = filter_rows(image);
+    std::vector<std::uint8_t> compressed = {0x78, 0x01}; // zlib header, 32K window, no dictionary
+    deflate(filtered, compressed);
+    if (compressed.size() > filtered.size() + filtered.size() / 65535 * 5 + 7) {
+        compressed.resize(2);
+        store(filtered, compressed);
+    }
+    put_u32(compressed, adler32(filtered));
+    put_chunk(png, "IDAT", compressed);
+
+    put_chunk(png, "IEND", {});
+    return png;
+}
+
+bool write_png(const std::string& path, const Image& image) {
+    const std::vector<std::uint8_t> png = encode_png(image);
+    if (png.empty()) {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "ERROR::PNG::FAILED_TO_OPEN: " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    return static_cast<bool>(file);
+}
+
+} // tools
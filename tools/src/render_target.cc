@@ -0,0 +1,62 @@
+#include "tools/render_target.h"
+#include <iostream>
+
+namespace tools {
+
+RenderTarget::RenderTarget(int width, int height) : _width(width), _height(height) {
+    glGenTextures(1, &_colour);
+    glBindTexture(GL_TEXTURE_2D, _colour);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenRenderbuffers(1, &_depth_stencil);
+    glBindRenderbuffer(GL_RENDERBUFFER, _depth_stencil);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _colour, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depth_stencil);
+
+    _valid = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (!_valid) {
+        std::cerr << "ERROR::RENDER_TARGET::INCOMPLETE_FRAMEBUFFER" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+RenderTarget::~RenderTarget() {
+    glDeleteFramebuffers(1, &_framebuffer);
+    glDeleteRenderbuffers(1, &_depth_stencil);
+    glDeleteTextures(1, &_colour);
+}
+
+void RenderTarget::bind() const {
+    glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+    glViewport(0, 0, _width, _height);
+}
+
+bool RenderTarget::valid() const {
+    return _valid;
+}
+
+int RenderTarget::width() const {
+    return _width;
+}
+
+int RenderTarget::height() const {
+    return _height;
+}
+
+unsigned int RenderTarget::framebuffer() const {
+    return _framebuffer;
+}
+
+unsigned int RenderTarget::colour_texture() const {
+    return _colour;
+}
+
+} // tools
@@ -0,0 +1,97 @@
+#include "tools/render_thread.h"
+#include <algorithm>
+
+namespace tools {
+
+RenderThread::RenderThread(Window& window, std::size_t buffer_count)
+        : _window(window), _buffers(std::max<std::size_t>(2, buffer_count)), _buffer_jobs(_buffers.size(), 0) {
+    // a context is current on one thread at a time
+    glfwMakeContextCurrent(nullptr);
+    _thread = std::thread(&RenderThread::render_loop, this);
+}
+
+RenderThread::~RenderThread() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // the loop drains the queue before it sees this
+        _stopping = true;
+    }
+    _work_ready.notify_one();
+    _thread.join();
+    _window.make_current();
+}
+
+CommandBuffer& RenderThread::begin_frame() {
+    const std::uint64_t last_use = _buffer_jobs[_recording];
+    std::unique_lock<std::mutex> lock(_mutex);
+    _job_done.wait(lock, [this, last_use] { return _done >= last_use; });
+    lock.unlock();
+
+    CommandBuffer& buffer = _buffers[_recording];
+    buffer.clear();
+    return buffer;
+}
+
+void RenderThread::submit_frame() {
+    _buffer_jobs[_recording] = queue(&_buffers[_recording], true);
+    _recording = (_recording + 1) % _buffers.size();
+}
+
+void RenderThread::invoke(const std::function<void()>& work) {
+    CommandBuffer commands;
+    commands.record(work);
+    const std::uint64_t job = queue(&commands, false);
+    std::unique_lock<std::mutex> lock(_mutex);
+    _job_done.wait(lock, [this, job] { return _done >= job; });
+}
+
+void RenderThread::finish() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _job_done.wait(lock, [this] { return _done == _queued; });
+}
+
+std::uint64_t RenderThread::frames_presented() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _presented;
+}
+
+std::uint64_t RenderThread::queue(const CommandBuffer* commands, bool present) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _jobs.push_back({commands, present});
+    const std::uint64_t job = ++_queued;
+    lock.unlock();
+    _work_ready.notify_one();
+    return job;
+}
+
+void RenderThread::render_loop() {
+    _window.make_current();
+    while (true) {
+        Job job{};
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _work_ready.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+            if (_jobs.empty()) {
+                break;
+            }
+            job = _jobs.front();
+            _jobs.pop_front();
+        }
+
+        _window.update_viewport();
+        job.commands->execute();
+        if (job.present) {
+            _window.swap_buffers();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            ++_done;
+            _presented += job.present;
+        }
+        _job_done.notify_all();
+    }
+    glfwMakeContextCurrent(nullptr);
+}
+
+} // tools
@@ -0,0 +1,110 @@
+#include "tools/sampler_cache.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace tools {
+
+namespace {
+
+/**
+ * the map needs equal descs to hash the same and every desc to equal itself: -0 goes to +0 (== says they're equal,
+ * their bits differ) and NaN, which equals nothing, goes to the default
+ */
+SamplerDesc normalized(SamplerDesc desc) {
+    desc.max_anisotropy = std::isnan(desc.max_anisotropy) ? 1.0f : desc.max_anisotropy + 0.0f;
+    desc.lod_bias = std::isnan(desc.lod_bias) ? 0.0f : desc.lod_bias + 0.0f;
+    return desc;
+}
+
+} // namespace
+
+std::size_t SamplerDescHash::operator()(const SamplerDesc& desc) const {
+    // FNV-1a over the fields, the float ones by their bits. + 0.0f makes -0 hash like the +0 it compares equal to
+    const std::uint32_t fields[] = {
+            static_cast<std::uint32_t>(desc.wrap_s),
+            static_cast<std::uint32_t>(desc.wrap_t),
+            static_cast<std::uint32_t>(desc.wrap_r),
+            static_cast<std::uint32_t>(desc.min_filter),
+            static_cast<std::uint32_t>(desc.mag_filter),
+            std::bit_cast<std::uint32_t>(desc.max_anisotropy + 0.0f),
+            std::bit_cast<std::uint32_t>(desc.lod_bias + 0.0f),
+    };
+
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::uint32_t field: fields) {
+        hash ^= field;
+        hash *= 1099511628211ull;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+SamplerCache::~SamplerCache() {
+    for (const auto& [desc, sampler]: _samplers) {
+        glDeleteSamplers(1, &sampler);
+    }
+}
+
+unsigned int SamplerCache::get(const SamplerDesc& requested) {
+    const SamplerDesc desc = normalized(requested);
+    const auto found = _samplers.find(desc);
+    if (found != _samplers.end()) {
+        return found->second;
+    }
+
+    const unsigned int sampler = create(desc);
+    _samplers.emplace(desc, sampler);
+    return sampler;
+}
+
+void SamplerCache::bind(unsigned int unit, const SamplerDesc& desc) {
+    const unsigned int sampler = get(desc);
+    if (unit >= _bound.size()) {
+        _bound.resize(unit + 1, 0);
+    }
+    if (_bound[unit] == sampler) {
+        return;
+    }
+    glBindSampler(unit, sampler);
+    _bound[unit] = sampler;
+}
+
+void SamplerCache::unbind(unsigned int unit) {
+    if (unit < _bound.size() && _bound[unit] != 0) {
+        glBindSampler(unit, 0);
+        _bound[unit] = 0;
+    }
+}
+
+std::size_t SamplerCache::size() const {
+    return _samplers.size();
+}
+
+unsigned int SamplerCache::create(const SamplerDesc& desc) {
+    unsigned int sampler;
+    glGenSamplers(1, &sampler);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, desc.wrap_s);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, desc.wrap_t);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, desc.wrap_r);
+    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, desc.min_filter);
+    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, desc.mag_filter);
+    glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, desc.lod_bias);
+
+    if (desc.max_anisotropy > 1.0f) {
+        if (_max_supported_anisotropy < 0.0f) {
+            // core since 4.6, before that it is an extension we don't load
+            _max_supported_anisotropy = 1.0f;
+            if (GLAD_GL_VERSION_4_6) {
+                glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &_max_supported_anisotropy);
+            }
+        }
+        if (_max_supported_anisotropy > 1.0f) {
+            glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY,
+                                std::min(desc.max_anisotropy, _max_supported_anisotropy));
+        }
+    }
+    return sampler;
+}
+
+} // tools
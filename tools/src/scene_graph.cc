@@ -0,0 +1,223 @@
+#include "tools/scene_graph.h"
+#include <algorithm>
+#include <atomic>
+
+namespace tools {
+
+namespace {
+
+// in _node_of_slot, the slot's node is gone and the slot goes away on the next rebuild
+constexpr SceneGraph::NodeId destroyed = std::numeric_limits<SceneGraph::NodeId>::max();
+
+template<typename T>
+void permute(std::vector<T>& values, const std::vector<std::uint32_t>& order) {
+    std::vector<T> permuted;
+    permuted.reserve(order.size());
+    for (std::uint32_t slot: order) {
+        permuted.push_back(values[slot]);
+    }
+    values = std::move(permuted);
+}
+
+} // namespace
+
+glm::mat4 to_matrix(const Transform& transform) {
+    const glm::mat3 rotation = glm::mat3_cast(transform.rotation);
+    glm::mat4 matrix;
+    matrix[0] = glm::vec4(rotation[0] * transform.scale.x, 0.0f);
+    matrix[1] = glm::vec4(rotation[1] * transform.scale.y, 0.0f);
+    matrix[2] = glm::vec4(rotation[2] * transform.scale.z, 0.0f);
+    matrix[3] = glm::vec4(transform.position, 1.0f);
+    return matrix;
+}
+
+SceneGraph::NodeId SceneGraph::create(NodeId parent, const Transform& local) {
+    NodeId node;
+    if (!_free_nodes.empty()) {
+        node = _free_nodes.back();
+        _free_nodes.pop_back();
+    } else {
+        node = static_cast<NodeId>(_slot_of_node.size());
+        _slot_of_node.push_back(no_slot);
+    }
+
+    const std::uint32_t parent_slot = parent == no_parent ? no_slot : _slot_of_node[parent];
+    const std::uint32_t depth = parent_slot == no_slot ? 0 : _depth[parent_slot] + 1;
+    // appending keeps parents first anyway, only the depth order may break
+    if (!_depth.empty() && depth < _depth.back()) {
+        _needs_rebuild = true;
+    }
+
+    _slot_of_node[node] = static_cast<std::uint32_t>(_parent.size());
+    _parent.push_back(parent_slot);
+    _depth.push_back(depth);
+    _local.push_back(local);
+    _local_matrix.emplace_back(1.0f);
+    _world.emplace_back(1.0f);
+    _dirty.push_back(1);
+    _changed.push_back(0);
+    _node_of_slot.push_back(node);
+    return node;
+}
+
+void SceneGraph::destroy(NodeId node) {
+    const std::uint32_t slot = _slot_of_node[node];
+    if (slot == no_slot) {
+        return;
+    }
+    // the children are found in rebuild(), by their parent being gone
+    _node_of_slot[slot] = destroyed;
+    _slot_of_node[node] = no_slot;
+    _free_nodes.push_back(node);
+    _needs_rebuild = true;
+}
+
+void SceneGraph::set_local(NodeId node, const Transform& local) {
+    const std::uint32_t slot = _slot_of_node[node];
+    _local[slot] = local;
+    _dirty[slot] = 1;
+}
+
+void SceneGraph::set_position(NodeId node, const glm::vec3& position) {
+    const std::uint32_t slot = _slot_of_node[node];
+    _local[slot].position = position;
+    _dirty[slot] = 1;
+}
+
+void SceneGraph::set_rotation(NodeId node, const glm::quat& rotation) {
+    const std::uint32_t slot = _slot_of_node[node];
+    _local[slot].rotation = rotation;
+    _dirty[slot] = 1;
+}
+
+void SceneGraph::set_scale(NodeId node, const glm::vec3& scale) {
+    const std::uint32_t slot = _slot_of_node[node];
+    _local[slot].scale = scale;
+    _dirty[slot] = 1;
+}
+
+const Transform& SceneGraph::local(NodeId node) const {
+    return _local[_slot_of_node[node]];
+}
+
+const glm::mat4& SceneGraph::world(NodeId node) const {
+    return _world[_slot_of_node[node]];
+}
+
+SceneGraph::NodeId SceneGraph::parent(NodeId node) const {
+    const std::uint32_t parent_slot = _parent[_slot_of_node[node]];
+    return parent_slot == no_slot ? no_parent : _node_of_slot[parent_slot];
+}
+
+bool SceneGraph::alive(NodeId node) const {
+    return node < _slot_of_node.size() && _slot_of_node[node] != no_slot;
+}
+
+std::size_t SceneGraph::update() {
+    if (_needs_rebuild) {
+        rebuild();
+    }
+    return update_range(0, _parent.size());
+}
+
+std::size_t SceneGraph::update(JobSystem& jobs) {
+    if (_needs_rebuild) {
+        rebuild();
+    }
+
+    // slots are sorted by depth, so a level is one contiguous run and only reads the level before it
+    std::atomic<std::size_t> recomputed{0};
+    const std::size_t count = _parent.size();
+    std::size_t level_begin = 0;
+    while (level_begin < count) {
+        const auto level_end = static_cast<std::size_t>(
+                std::upper_bound(_depth.begin() + static_cast<std::ptrdiff_t>(level_begin), _depth.end(),
+                                 _depth[level_begin]) - _depth.begin());
+        jobs.parallel_for(level_begin, level_end, 1024, [this, &recomputed](std::size_t first, std::size_t last) {
+            recomputed += update_range(first, last);
+        });
+        level_begin = level_end;
+    }
+    return recomputed.load();
+}
+
+std::size_t SceneGraph::update_range(std::size_t first, std::size_t last) {
+    std::size_t recomputed = 0;
+    for (std::size_t slot = first; slot < last; ++slot) {
+        const std::uint32_t parent_slot = _parent[slot];
+        const bool parent_changed = parent_slot != no_slot && _changed[parent_slot];
+        _changed[slot] = _dirty[slot] | parent_changed;
+        if (!_changed[slot]) {
+            continue;
+        }
+
+        if (_dirty[slot]) {
+            _local_matrix[slot] = to_matrix(_local[slot]);
+            _dirty[slot] = 0;
+        }
+        _world[slot] = parent_slot == no_slot ? _local_matrix[slot] : _world[parent_slot] * _local_matrix[slot];
+        ++recomputed;
+    }
+    return recomputed;
+}
+
+std::size_t SceneGraph::size() const {
+    return _parent.size();
+}
+
+std::span<const glm::mat4> SceneGraph::world_matrices() const {
+    return _world;
+}
+
+std::uint32_t SceneGraph::slot(NodeId node) const {
+    return _slot_of_node[node];
+}
+
+void SceneGraph::rebuild() {
+    // parents come before children, so one pass finds every orphaned subtree
+    const std::size_t count = _parent.size();
+    std::vector<std::uint32_t> order;
+    order.reserve(count);
+    for (std::uint32_t slot = 0; slot < count; ++slot) {
+        const std::uint32_t parent_slot = _parent[slot];
+        if (_node_of_slot[slot] != destroyed && parent_slot != no_slot && _node_of_slot[parent_slot] == destroyed) {
+            const NodeId orphan = _node_of_slot[slot];
+            _slot_of_node[orphan] = no_slot;
+            _free_nodes.push_back(orphan);
+            _node_of_slot[slot] = destroyed;
+        }
+        if (_node_of_slot[slot] != destroyed) {
+            order.push_back(slot);
+        }
+    }
+
+    std::stable_sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+        return _depth[a] < _depth[b];
+    });
+
+    std::vector<std::uint32_t> new_slot(count, no_slot);
+    for (std::uint32_t i = 0; i < order.size(); ++i) {
+        new_slot[order[i]] = i;
+    }
+
+    permute(_parent, order);
+    for (std::uint32_t& parent_slot: _parent) {
+        if (parent_slot != no_slot) {
+            parent_slot = new_slot[parent_slot];
+        }
+    }
+    permute(_depth, order);
+    permute(_local, order);
+    permute(_local_matrix, order);
+    permute(_world, order);
+    permute(_dirty, order);
+    permute(_changed, order);
+    permute(_node_of_slot, order);
+
+    for (std::uint32_t slot = 0; slot < _node_of_slot.size(); ++slot) {
+        _slot_of_node[_node_of_slot[slot]] = slot;
+    }
+    _needs_rebuild = false;
+}
+
+} // tools
@@ -100,6 +100,7 @@ template void Shader::set_uniform_data<glm::vec2>(const std::string&, const glm:
 template void Shader::set_uniform_data<glm::vec3>(const std::string&, const glm::vec3&);
 template void Shader::set_uniform_data<glm::vec4>(const std::string&, const glm::vec4&);
 template void Shader::set_uniform_data<glm::mat3>(const std::string&, const glm::mat3&);
+template void Shader::set_uniform_data<glm::mat4>(const std::string&, const glm::mat4&);
 
 
 }
\ No newline at end of file
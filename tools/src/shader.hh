@@ -27,6 +27,8 @@ inline void Shader::set_uniform_data(const std::string& name, const T& data) {
         glUniform4f(loc, data.x, data.y, data.z, data.w);
     } else if constexpr (std::is_same_v<T, glm::mat3>) {
         glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(data));
+    } else if constexpr (std::is_same_v<T, glm::mat4>) {
+        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(data));
     } else {
         static_assert(!sizeof(T), "Unsupported uniform type for set_uniform_data");
     }
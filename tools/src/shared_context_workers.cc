@@ -0,0 +1,119 @@
+#include "tools/shared_context_workers.h"
+#include <algorithm>
+#include <iostream>
+
+namespace tools {
+
+GlJob::~GlJob() {
+    // sync objects are shared, whichever context is current can delete it
+    if (_fence != nullptr && glfwGetCurrentContext() != nullptr) {
+        glDeleteSync(_fence);
+    }
+}
+
+bool GlJob::ready() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_done) {
+        return false;
+    }
+    if (_fence == nullptr) {
+        return true;
+    }
+    const GLenum status = glClientWaitSync(_fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        return false;
+    }
+    glDeleteSync(_fence);
+    _fence = nullptr;
+    return true;
+}
+
+void GlJob::wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _completed.wait(lock, [this] { return _done; });
+    if (_fence != nullptr) {
+        // deleting it right away is fine, GL keeps it until the wait is over
+        glWaitSync(_fence, 0, GL_TIMEOUT_IGNORED);
+        glDeleteSync(_fence);
+        _fence = nullptr;
+    }
+}
+
+void GlJob::complete(GLsync fence) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _fence = fence;
+        _done = true;
+    }
+    _completed.notify_all();
+}
+
+SharedContextWorkers::SharedContextWorkers(Window& window, unsigned int worker_count) : _window(window) {
+    for (unsigned int i = 0; i < std::max(1u, worker_count); ++i) {
+        GLFWwindow* context = _window.create_shared_context();
+        if (context == nullptr) {
+            break;
+        }
+        _contexts.push_back(context);
+        _workers.emplace_back(&SharedContextWorkers::worker_loop, this, context);
+    }
+}
+
+SharedContextWorkers::~SharedContextWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _condition.notify_all();
+    for (auto& worker: _workers) {
+        worker.join();
+    }
+    for (GLFWwindow* context: _contexts) {
+        _window.destroy_shared_context(context);
+    }
+}
+
+std::shared_ptr<GlJob> SharedContextWorkers::submit(std::function<void()> job) {
+    auto handoff = std::make_shared<GlJob>();
+    enqueue(handoff, std::move(job));
+    return handoff;
+}
+
+void SharedContextWorkers::enqueue(std::shared_ptr<GlJob> handoff, std::function<void()> work) {
+    if (_workers.empty()) {
+        // no context to run it on, complete it empty rather than leave get() waiting forever
+        std::cerr << "ERROR::SHARED_CONTEXT_WORKERS::NO_CONTEXT" << std::endl;
+        handoff->complete(nullptr);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs.push_back({std::move(handoff), std::move(work)});
+    }
+    _condition.notify_one();
+}
+
+void SharedContextWorkers::worker_loop(GLFWwindow* context) {
+    glfwMakeContextCurrent(context);
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+            if (_jobs.empty()) {
+                break;
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        job.work();
+        // the flush gets the fence to the GPU, otherwise another context could wait on it forever
+        GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+        job.handoff->complete(fence);
+    }
+    glfwMakeContextCurrent(nullptr);
+}
+
+} // tools
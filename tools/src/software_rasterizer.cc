@@ -0,0 +1,463 @@
+#include "tools/software_rasterizer.h"
+#include "cpu_features.hh"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace tools {
+
+namespace {
+
+constexpr int tile_size = 64;
+constexpr int max_size = 4096;
+constexpr double subpixels = 256.0;
+// x and y are clipped to +-2w, so snapped coordinates stay under 2^21 and every edge function term
+// is an integer under 2^53: exact in a double
+constexpr float guard_band = 2.0f;
+constexpr float near_w = 1e-5f;
+constexpr int max_clipped = 16;
+
+RasterVertex lerp(const RasterVertex& a, const RasterVertex& b, float t) {
+    return {a.position + (b.position - a.position) * t, a.colour + (b.colour - a.colour) * t, a.uv + (b.uv - a.uv) * t};
+}
+
+/**
+ * distance >= 0 is inside. the polygon is a triangle fan
+ */
+float plane_distance(const glm::vec4& p, int plane) {
+    switch (plane) {
+        case 0: return p.w - near_w;
+        case 1: return guard_band * p.w - p.x;
+        case 2: return guard_band * p.w + p.x;
+        case 3: return guard_band * p.w - p.y;
+        case 4: return guard_band * p.w + p.y;
+        case 5: return p.w - p.z;
+        default: return p.w + p.z;
+    }
+}
+
+constexpr int plane_count = 7;
+
+bool inside_all(const glm::vec4& p) {
+    for (int plane = 0; plane < plane_count; ++plane) {
+        if (plane_distance(p, plane) < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Sutherland-Hodgman against every plane
+ * @return vertex count of the clipped polygon, less than 3 when nothing is left
+ */
+int clip_polygon(RasterVertex* polygon, int count) {
+    RasterVertex scratch[max_clipped];
+    for (int plane = 0; plane < plane_count && count >= 3; ++plane) {
+        int out = 0;
+        for (int i = 0; i < count; ++i) {
+            const RasterVertex& current = polygon[i];
+            const RasterVertex& next = polygon[(i + 1) % count];
+            const float d_current = plane_distance(current.position, plane);
+            const float d_next = plane_distance(next.position, plane);
+            if (d_current >= 0.0f) {
+                scratch[out++] = current;
+            }
+            if ((d_current >= 0.0f) != (d_next >= 0.0f) && out < max_clipped) {
+                scratch[out++] = lerp(current, next, d_current / (d_current - d_next));
+            }
+        }
+        count = std::min(out, max_clipped);
+        std::copy(scratch, scratch + count, polygon);
+    }
+    return count;
+}
+
+int wrap(int i, int size, GLint mode) {
+    switch (mode) {
+        case GL_CLAMP_TO_EDGE:
+            return std::clamp(i, 0, size - 1);
+        case GL_CLAMP_TO_BORDER:
+            return i < 0 || i >= size ? -1 : i;
+        case GL_MIRRORED_REPEAT: {
+            // (size - 1) - mirror((i mod 2size) - size), the GL spec's table
+            const int m = ((i % (2 * size)) + 2 * size) % (2 * size) - size;
+            return size - 1 - (m >= 0 ? m : -(1 + m));
+        }
+        default:
+            return ((i % size) + size) % size;
+    }
+}
+
+/**
+ * border texels are transparent black, channels the image doesn't have read like GL's R8 / RG8 / RGB8
+ */
+glm::vec4 texel(const Image& image, int x, int y) {
+    if (x < 0 || y < 0) {
+        return glm::vec4(0.0f);
+    }
+    const unsigned char* p = &image.pixels[(static_cast<std::size_t>(y) * image.width + x) * image.channels];
+    glm::vec4 colour(0.0f, 0.0f, 0.0f, 1.0f);
+    for (int c = 0; c < std::min(image.channels, 4); ++c) {
+        colour[c] = p[c] / 255.0f;
+    }
+    return colour;
+}
+
+glm::vec4 sample(const Image& image, const SamplerDesc& sampler, glm::vec2 uv) {
+    const float u = uv.x * static_cast<float>(image.width);
+    const float v = uv.y * static_cast<float>(image.height);
+    if (sampler.mag_filter == GL_NEAREST) {
+        return texel(image, wrap(static_cast<int>(std::floor(u)), image.width, sampler.wrap_s),
+                     wrap(static_cast<int>(std::floor(v)), image.height, sampler.wrap_t));
+    }
+
+    const float x = std::floor(u - 0.5f);
+    const float y = std::floor(v - 0.5f);
+    const float fx = u - 0.5f - x;
+    const float fy = v - 0.5f - y;
+    const int x0 = wrap(static_cast<int>(x), image.width, sampler.wrap_s);
+    const int x1 = wrap(static_cast<int>(x) + 1, image.width, sampler.wrap_s);
+    const int y0 = wrap(static_cast<int>(y), image.height, sampler.wrap_t);
+    const int y1 = wrap(static_cast<int>(y) + 1, image.height, sampler.wrap_t);
+    const glm::vec4 top = texel(image, x0, y0) * (1.0f - fx) + texel(image, x1, y0) * fx;
+    const glm::vec4 bottom = texel(image, x0, y1) * (1.0f - fx) + texel(image, x1, y1) * fx;
+    return top * (1.0f - fy) + bottom * fy;
+}
+
+/**
+ * ties to even, as the float to int conversion of SSE and llvmpipe
+ */
+unsigned char to_unorm8(float value) {
+    return static_cast<unsigned char>(std::nearbyint(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+} // namespace
+
+struct SoftwareRasterizer::Triangle {
+    // edge i, opposite vertex i: a * x + b * y + c with x, y in subpixels, positive inside
+    double a[3];
+    double b[3];
+    double c[3];
+    double bias[3]; // 0 on top and left edges, -1 elsewhere: the edge functions are integers
+    double area; // the three edge functions always add up to this
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    // divided by w for perspective correct interpolation
+    float inverse_w[3];
+    glm::vec4 colour[3];
+    glm::vec2 uv[3];
+    std::uint32_t draw;
+};
+
+namespace {
+
+/**
+ * @param e the unbiased edge functions at the pixel centre
+ */
+void shade(const SoftwareRasterizer::Triangle& triangle, const RasterDraw& draw, double e0, double e1, double e2,
+           unsigned char* out) {
+    glm::vec4 colour = draw.colour;
+    if (draw.shading != Shading::constant) {
+        const float l0 = static_cast<float>(e0 / triangle.area);
+        const float l1 = static_cast<float>(e1 / triangle.area);
+        const float l2 = static_cast<float>(e2 / triangle.area);
+        const float w = 1.0f / (l0 * triangle.inverse_w[0] + l1 * triangle.inverse_w[1] + l2 * triangle.inverse_w[2]);
+        if (draw.shading == Shading::vertex_colour) {
+            colour = (triangle.colour[0] * l0 + triangle.colour[1] * l1 + triangle.colour[2] * l2) * w;
+        } else {
+            const glm::vec2 uv = (triangle.uv[0] * l0 + triangle.uv[1] * l1 + triangle.uv[2] * l2) * w;
+            colour = sample(*draw.textures[0], draw.samplers[0], uv);
+            if (draw.shading == Shading::texture_mix) {
+                colour += (sample(*draw.textures[1], draw.samplers[1], uv) - colour) * draw.mix;
+            }
+        }
+    }
+    for (int c = 0; c < 4; ++c) {
+        out[c] = to_unorm8(colour[c]);
+    }
+}
+
+#ifdef TOOLS_X86
+
+/**
+ * tests four pixels of a row per iteration, shades the covered ones
+ */
+__attribute__((target("avx2")))
+void rasterize_rows_avx2(const SoftwareRasterizer::Triangle& triangle, const RasterDraw& draw, Image& image,
+                         int x_begin, int x_end, int y_begin, int y_end) {
+    const __m256d lanes = _mm256_set_pd(3.0, 2.0, 1.0, 0.0);
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d step[3];
+    __m256d lane_step[3];
+    for (int i = 0; i < 3; ++i) {
+        step[i] = _mm256_set1_pd(triangle.a[i] * subpixels * 4.0);
+        lane_step[i] = _mm256_mul_pd(_mm256_set1_pd(triangle.a[i] * subpixels), lanes);
+    }
+
+    for (int y = y_begin; y <= y_end; ++y) {
+        const double py = y * subpixels + subpixels / 2.0;
+        const double px = x_begin * subpixels + subpixels / 2.0;
+        __m256d e[3];
+        for (int i = 0; i < 3; ++i) {
+            const double start = triangle.a[i] * px + triangle.b[i] * py + triangle.c[i] + triangle.bias[i];
+            e[i] = _mm256_add_pd(_mm256_set1_pd(start), lane_step[i]);
+        }
+        unsigned char* row = &image.pixels[static_cast<std::size_t>(image.height - 1 - y) * image.width * 4];
+
+        for (int x = x_begin; x <= x_end; x += 4) {
+            const __m256d inside = _mm256_and_pd(
+                    _mm256_and_pd(_mm256_cmp_pd(e[0], zero, _CMP_GE_OQ), _mm256_cmp_pd(e[1], zero, _CMP_GE_OQ)),
+                    _mm256_cmp_pd(e[2], zero, _CMP_GE_OQ));
+            int mask = _mm256_movemask_pd(inside);
+            if (x_end - x < 3) {
+                mask &= (1 << (x_end - x + 1)) - 1;
+            }
+            if (mask != 0) {
+                alignas(32) double values[3][4];
+                for (int i = 0; i < 3; ++i) {
+                    _mm256_store_pd(values[i], e[i]);
+                }
+                for (int lane = 0; lane < 4; ++lane) {
+                    if (mask & (1 << lane)) {
+                        shade(triangle, draw, values[0][lane] - triangle.bias[0], values[1][lane] - triangle.bias[1],
+                              values[2][lane] - triangle.bias[2], &row[(x + lane) * 4]);
+                    }
+                }
+            }
+            for (int i = 0; i < 3; ++i) {
+                e[i] = _mm256_add_pd(e[i], step[i]);
+            }
+        }
+    }
+}
+
+#endif
+
+void rasterize_rows(const SoftwareRasterizer::Triangle& triangle, const RasterDraw& draw, Image& image,
+                    int x_begin, int x_end, int y_begin, int y_end) {
+#ifdef TOOLS_X86
+    if (has_avx2()) {
+        rasterize_rows_avx2(triangle, draw, image, x_begin, x_end, y_begin, y_end);
+        return;
+    }
+#endif
+    for (int y = y_begin; y <= y_end; ++y) {
+        const double py = y * subpixels + subpixels / 2.0;
+        const double px = x_begin * subpixels + subpixels / 2.0;
+        double e[3];
+        for (int i = 0; i < 3; ++i) {
+            e[i] = triangle.a[i] * px + triangle.b[i] * py + triangle.c[i] + triangle.bias[i];
+        }
+        unsigned char* row = &image.pixels[static_cast<std::size_t>(image.height - 1 - y) * image.width * 4];
+
+        for (int x = x_begin; x <= x_end; ++x) {
+            if (e[0] >= 0.0 && e[1] >= 0.0 && e[2] >= 0.0) {
+                shade(triangle, draw, e[0] - triangle.bias[0], e[1] - triangle.bias[1], e[2] - triangle.bias[2],
+                      &row[x * 4]);
+            }
+            for (int i = 0; i < 3; ++i) {
+                e[i] += triangle.a[i] * subpixels;
+            }
+        }
+    }
+}
+
+} // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(int width, int height, JobSystem* jobs)
+        : _width(std::clamp(width, 1, max_size)), _height(std::clamp(height, 1, max_size)), _jobs(jobs) {
+    if (width != _width || height != _height) {
+        std::cerr << "ERROR::SOFTWARE_RASTERIZER::UNSUPPORTED_SIZE: " << width << "x" << height << ", clamped to "
+                  << _width << "x" << _height << std::endl;
+    }
+    _tiles_x = (_width + tile_size - 1) / tile_size;
+    _tiles_y = (_height + tile_size - 1) / tile_size;
+    _bins.resize(static_cast<std::size_t>(_tiles_x) * _tiles_y);
+    _image.width = _width;
+    _image.height = _height;
+    _image.channels = 4;
+    _image.pixels.assign(static_cast<std::size_t>(_width) * _height * 4, 0);
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() = default;
+
+void SoftwareRasterizer::clear(const glm::vec4& colour) {
+    _clear_pending = true;
+    for (int c = 0; c < 4; ++c) {
+        _clear_colour[c] = to_unorm8(colour[c]);
+    }
+    _draws.clear();
+    _triangles.clear();
+    for (auto& bin: _bins) {
+        bin.clear();
+    }
+}
+
+void SoftwareRasterizer::draw(std::span<const RasterVertex> vertices, std::span<const std::uint32_t> indices,
+                              const RasterDraw& draw) {
+    const bool textured = draw.shading == Shading::texture || draw.shading == Shading::texture_mix;
+    for (int i = 0; i < (draw.shading == Shading::texture_mix ? 2 : textured ? 1 : 0); ++i) {
+        const Image* texture = draw.textures[i];
+        if (texture == nullptr || texture->width <= 0 || texture->height <= 0 || texture->channels < 1 ||
+            texture->pixels.size() < static_cast<std::size_t>(texture->width) * texture->height * texture->channels) {
+            std::cerr << "ERROR::SOFTWARE_RASTERIZER::MISSING_TEXTURE: " << i << std::endl;
+            return;
+        }
+    }
+    for (std::uint32_t index: indices) {
+        if (index >= vertices.size()) {
+            std::cerr << "ERROR::SOFTWARE_RASTERIZER::INDEX_OUT_OF_RANGE: " << index << std::endl;
+            return;
+        }
+    }
+
+    const auto draw_index = static_cast<std::uint32_t>(_draws.size());
+    _draws.push_back(draw);
+
+    const std::size_t count = indices.empty() ? vertices.size() : indices.size();
+    for (std::size_t first = 0; first + 3 <= count; first += 3) {
+        RasterVertex polygon[max_clipped];
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+            polygon[corner] = vertices[indices.empty() ? first + corner : indices[first + corner]];
+            polygon[corner].position = draw.transform * polygon[corner].position;
+        }
+
+        int corners = 3;
+        if (!inside_all(polygon[0].position) || !inside_all(polygon[1].position) ||
+            !inside_all(polygon[2].position)) {
+            corners = clip_polygon(polygon, 3);
+        }
+        for (int i = 1; i + 1 < corners; ++i) {
+            const RasterVertex fan[3] = {polygon[0], polygon[i], polygon[i + 1]};
+            setup(fan, draw_index);
+        }
+    }
+}
+
+void SoftwareRasterizer::setup(const RasterVertex* corners, std::uint32_t draw) {
+    Triangle triangle{};
+    triangle.draw = draw;
+    double x[3];
+    double y[3];
+    for (int i = 0; i < 3; ++i) {
+        const glm::vec4& p = corners[i].position;
+        const float inverse_w = 1.0f / p.w;
+        // window coordinates, y up like GL, snapped to 1/256 pixel
+        x[i] = std::round((p.x * inverse_w + 1.0) * 0.5 * _width * subpixels);
+        y[i] = std::round((p.y * inverse_w + 1.0) * 0.5 * _height * subpixels);
+        triangle.inverse_w[i] = inverse_w;
+        triangle.colour[i] = corners[i].colour * inverse_w;
+        triangle.uv[i] = corners[i].uv * inverse_w;
+    }
+
+    triangle.area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (triangle.area == 0.0) {
+        return;
+    }
+    if (triangle.area < 0.0) {
+        // no culling, clockwise triangles are turned around
+        std::swap(x[1], x[2]);
+        std::swap(y[1], y[2]);
+        std::swap(triangle.inverse_w[1], triangle.inverse_w[2]);
+        std::swap(triangle.colour[1], triangle.colour[2]);
+        std::swap(triangle.uv[1], triangle.uv[2]);
+        triangle.area = -triangle.area;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        const int from = (i + 1) % 3;
+        const int to = (i + 2) % 3;
+        triangle.a[i] = y[from] - y[to];
+        triangle.b[i] = x[to] - x[from];
+        triangle.c[i] = -(triangle.a[i] * x[from] + triangle.b[i] * y[from]);
+        // counter-clockwise with y up: left edges go down, top edges go left
+        const bool top_left = triangle.a[i] > 0.0 || (triangle.a[i] == 0.0 && triangle.b[i] < 0.0);
+        triangle.bias[i] = top_left ? 0.0 : -1.0;
+    }
+
+    // pixels whose centres can be covered
+    const double half = subpixels / 2.0;
+    triangle.min_x = std::max(0, static_cast<int>(std::ceil((std::min({x[0], x[1], x[2]}) - half) / subpixels)));
+    triangle.min_y = std::max(0, static_cast<int>(std::ceil((std::min({y[0], y[1], y[2]}) - half) / subpixels)));
+    triangle.max_x = std::min(_width - 1,
+                              static_cast<int>(std::floor((std::max({x[0], x[1], x[2]}) - half) / subpixels)));
+    triangle.max_y = std::min(_height - 1,
+                              static_cast<int>(std::floor((std::max({y[0], y[1], y[2]}) - half) / subpixels)));
+    if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y) {
+        return;
+    }
+
+    const auto index = static_cast<std::uint32_t>(_triangles.size());
+    _triangles.push_back(triangle);
+    for (int ty = triangle.min_y / tile_size; ty <= triangle.max_y / tile_size; ++ty) {
+        for (int tx = triangle.min_x / tile_size; tx <= triangle.max_x / tile_size; ++tx) {
+            _bins[static_cast<std::size_t>(ty) * _tiles_x + tx].push_back(index);
+        }
+    }
+}
+
+void SoftwareRasterizer::finish() {
+    if (!_clear_pending && _triangles.empty()) {
+        return;
+    }
+
+    // tiles don't share pixels, so they need no synchronisation at all
+    const auto tile_count = static_cast<std::size_t>(_tiles_x) * _tiles_y;
+    auto rasterize = [this](std::size_t first, std::size_t last) {
+        for (std::size_t tile = first; tile < last; ++tile) {
+            rasterize_tile(static_cast<int>(tile));
+        }
+    };
+    if (_jobs != nullptr) {
+        _jobs->parallel_for(0, tile_count, 1, rasterize);
+    } else {
+        rasterize(0, tile_count);
+    }
+
+    _clear_pending = false;
+    _draws.clear();
+    _triangles.clear();
+    for (auto& bin: _bins) {
+        bin.clear();
+    }
+}
+
+void SoftwareRasterizer::rasterize_tile(int tile) {
+    const int x_begin = (tile % _tiles_x) * tile_size;
+    const int y_begin = (tile / _tiles_x) * tile_size;
+    const int x_end = std::min(x_begin + tile_size, _width) - 1;
+    const int y_end = std::min(y_begin + tile_size, _height) - 1;
+
+    if (_clear_pending) {
+        for (int y = y_begin; y <= y_end; ++y) {
+            unsigned char* row = &_image.pixels[static_cast<std::size_t>(_height - 1 - y) * _width * 4];
+            for (int x = x_begin; x <= x_end; ++x) {
+                std::copy(_clear_colour, _clear_colour + 4, &row[x * 4]);
+            }
+        }
+    }
+
+    for (std::uint32_t index: _bins[tile]) {
+        const Triangle& triangle = _triangles[index];
+        rasterize_rows(triangle, _draws[triangle.draw], _image, std::max(x_begin, triangle.min_x),
+                       std::min(x_end, triangle.max_x), std::max(y_begin, triangle.min_y),
+                       std::min(y_end, triangle.max_y));
+    }
+}
+
+const Image& SoftwareRasterizer::image() const {
+    return _image;
+}
+
+int SoftwareRasterizer::width() const {
+    return _width;
+}
+
+int SoftwareRasterizer::height() const {
+    return _height;
+}
+
+} // tools
@@ -0,0 +1,241 @@
+#include "tools/texture.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+namespace tools {
+
+bool load_image(const std::string& path, Image& out, bool flip_vertically, int desired_channels) {
+    // the thread variant, so decoding on worker threads doesn't fight over the global flag
+    stbi_set_flip_vertically_on_load_thread(flip_vertically);
+
+    int channels;
+    unsigned char* data = stbi_load(path.c_str(), &out.width, &out.height, &channels, desired_channels);
+    stbi_set_flip_vertically_on_load_thread(false);
+    if (!data) {
+        std::cerr << "ERROR::TEXTURE::FAILED_TO_LOAD: " << path << std::endl;
+        return false;
+    }
+
+    out.channels = desired_channels != 0 ? desired_channels : channels;
+    const std::size_t size = static_cast<std::size_t>(out.width) * out.height * out.channels;
+    out.pixels.assign(data, data + size);
+    stbi_image_free(data);
+    return true;
+}
+
+Image half_size(const Image& image) {
+    Image half;
+    half.width = std::max(1, image.width / 2);
+    half.height = std::max(1, image.height / 2);
+    half.channels = image.channels;
+    half.pixels.resize(static_cast<std::size_t>(half.width) * half.height * half.channels);
+
+    const auto at = [&image](int x, int y, int c) {
+        return image.pixels[(static_cast<std::size_t>(y) * image.width + x) * image.channels + c];
+    };
+    for (int y = 0; y < half.height; ++y) {
+        const int y0 = std::min(y * 2, image.height - 1);
+        const int y1 = std::min(y * 2 + 1, image.height - 1);
+        for (int x = 0; x < half.width; ++x) {
+            const int x0 = std::min(x * 2, image.width - 1);
+            const int x1 = std::min(x * 2 + 1, image.width - 1);
+            for (int c = 0; c < half.channels; ++c) {
+                const int sum = at(x0, y0, c) + at(x1, y0, c) + at(x0, y1, c) + at(x1, y1, c);
+                half.pixels[(static_cast<std::size_t>(y) * half.width + x) * half.channels + c] =
+                        static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return half;
+}
+
+TextureFormat texture_format_for(int channels, bool srgb) {
+    switch (channels) {
+        case 1:
+            return {GL_R8, GL_RED};
+        case 2:
+            return {GL_RG8, GL_RG};
+        case 3:
+            return {static_cast<GLenum>(srgb ? GL_SRGB8 : GL_RGB8), GL_RGB};
+        default:
+            return {static_cast<GLenum>(srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8), GL_RGBA};
+    }
+}
+
+int mip_count(int width, int height) {
+    int levels = 1;
+    for (int size = std::max(width, height); size > 1; size >>= 1) {
+        ++levels;
+    }
+    return levels;
+}
+
+static GLint unpack_alignment_for(int width, int channels) {
+    const int row_bytes = width * channels;
+    if (row_bytes % 8 == 0) {
+        return 8;
+    }
+    if (row_bytes % 4 == 0) {
+        return 4;
+    }
+    return row_bytes % 2 == 0 ? 2 : 1;
+}
+
+Texture::Texture(const std::string& path, const TextureDesc& desc) {
+    Image image;
+    if (load_image(path, image, desc.flip_vertically)) {
+        upload(image, desc);
+    }
+}
+
+Texture::Texture(const Image& image, const TextureDesc& desc) {
+    upload(image, desc);
+}
+
+Texture::Texture(const CompressedImage& image, const TextureDesc& desc) {
+    upload(image, desc);
+}
+
+Texture::~Texture() {
+    if (_id != 0) {
+        glDeleteTextures(1, &_id);
+    }
+}
+
+Texture::Texture(Texture&& other) noexcept
+        : _id(std::exchange(other._id, 0)), _width(other._width), _height(other._height), _format(other._format) {
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept {
+    if (this != &other) {
+        if (_id != 0) {
+            glDeleteTextures(1, &_id);
+        }
+        _id = std::exchange(other._id, 0);
+        _width = other._width;
+        _height = other._height;
+        _format = other._format;
+    }
+    return *this;
+}
+
+void Texture::upload(const Image& image, const TextureDesc& desc) {
+    _width = image.width;
+    _height = image.height;
+    _format = texture_format_for(image.channels, desc.srgb);
+    const int levels = desc.mipmaps ? mip_count(_width, _height) : 1;
+
+    glGenTextures(1, &_id);
+    glBindTexture(GL_TEXTURE_2D, _id);
+
+    allocate(levels);
+
+    // GL assumes rows start on 4 byte boundaries, an odd width RGB/R image doesn't
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment_for(_width, image.channels));
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _width, _height, _format.format, GL_UNSIGNED_BYTE, image.pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (image.channels == 1) {
+        const GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    } else if (image.channels == 2) {
+        // grey + alpha
+        const GLint swizzle[] = {GL_RED, GL_RED, GL_RED, GL_GREEN};
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, desc.wrap_s);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, desc.wrap_t);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, desc.mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    if (desc.mipmaps) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
+void Texture::upload(const CompressedImage& image, const TextureDesc& desc) {
+    if (image.levels.empty()) {
+        return;
+    }
+
+    _width = image.width;
+    _height = image.height;
+    _format = {compressed_internal_format(image.format, image.srgb), GL_NONE};
+    const int levels = static_cast<int>(image.levels.size());
+
+    glGenTextures(1, &_id);
+    glBindTexture(GL_TEXTURE_2D, _id);
+    allocate(levels);
+
+    int level_width = _width;
+    int level_height = _height;
+    for (int level = 0; level < levels; ++level) {
+        const auto& data = image.levels[static_cast<std::size_t>(level)];
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, level_width, level_height, _format.internal_format,
+                                  static_cast<GLsizei>(data.size()), data.data());
+        level_width = std::max(1, level_width / 2);
+        level_height = std::max(1, level_height / 2);
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, desc.wrap_s);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, desc.wrap_t);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
+
+void Texture::allocate(int levels) {
+    if (GLAD_GL_VERSION_4_2) {
+        // immutable storage, the driver never has to check whether the mip chain is complete
+        glTexStorage2D(GL_TEXTURE_2D, levels, _format.internal_format, _width, _height);
+        return;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    int level_width = _width;
+    int level_height = _height;
+    for (int level = 0; level < levels; ++level) {
+        if (_format.format == GL_NONE) {
+            // compressed, the data comes with glCompressedTexSubImage2D right after
+            const GLsizei size = ((level_width + 3) / 4) * ((level_height + 3) / 4) *
+                                 (_format.internal_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ||
+                                  _format.internal_format == GL_COMPRESSED_SRGB_S3TC_DXT1_EXT ? 8 : 16);
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, _format.internal_format, level_width, level_height, 0, size,
+                                   nullptr);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(_format.internal_format), level_width, level_height,
+                         0, _format.format, GL_UNSIGNED_BYTE, nullptr);
+        }
+        level_width = std::max(1, level_width / 2);
+        level_height = std::max(1, level_height / 2);
+    }
+}
+
+void Texture::bind(unsigned int unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, _id);
+}
+
+bool Texture::valid() const {
+    return _id != 0;
+}
+
+unsigned int Texture::id() const {
+    return _id;
+}
+
+int Texture::width() const {
+    return _width;
+}
+
+int Texture::height() const {
+    return _height;
+}
+
+TextureFormat Texture::format() const {
+    return _format;
+}
+
+} // tools
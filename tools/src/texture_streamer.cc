@@ -0,0 +1,266 @@
+#include "tools/texture_streamer.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iostream>
+
+namespace tools {
+
+TextureStreamer::TextureStreamer(std::size_t budget_bytes, int tail_size, JobSystem& jobs)
+        : _budget(budget_bytes), _tail_size(tail_size), _job_system(jobs) {
+    const unsigned char grey[] = {128, 128, 128, 255};
+    glGenTextures(1, &_placeholder);
+    glBindTexture(GL_TEXTURE_2D, _placeholder);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+TextureStreamer::~TextureStreamer() {
+    // loads already running finish, the queued ones return right away
+    _stopping = true;
+    _job_system.wait(_loads);
+
+    for (auto& entry: _entries) {
+        glDeleteTextures(1, &entry.id);
+    }
+    glDeleteTextures(1, &_placeholder);
+}
+
+int TextureStreamer::add(const std::string& path, const TextureDesc& desc) {
+    Entry entry{};
+    entry.path = path;
+    entry.compressed = path.size() > 4 && path.compare(path.size() - 4, 4, ".dds") == 0;
+    entry.flip_vertically = desc.flip_vertically;
+
+    CompressedImage header;
+    if (entry.compressed) {
+        // reads only the header, every level gets skipped
+        if (!load_dds(path, header, INT_MAX)) {
+            return -1;
+        }
+        entry.width = header.width;
+        entry.height = header.height;
+        entry.block_format = header.format;
+        entry.format = {compressed_internal_format(header.format, header.srgb), GL_NONE};
+        // the file's chain may stop early (only the base level, say), asking for more would fail every load
+        entry.levels = std::min(header.level_count, mip_count(entry.width, entry.height));
+    } else {
+        if (!stbi_info(path.c_str(), &entry.width, &entry.height, &entry.channels)) {
+            std::cerr << "ERROR::TEXTURE_STREAMER::FAILED_TO_READ: " << path << std::endl;
+            return -1;
+        }
+        entry.format = texture_format_for(entry.channels, desc.srgb);
+        entry.levels = mip_count(entry.width, entry.height);
+    }
+
+    entry.tail_level = 0;
+    while (entry.tail_level < entry.levels - 1 &&
+           std::max(entry.width >> entry.tail_level, entry.height >> entry.tail_level) > _tail_size) {
+        ++entry.tail_level;
+    }
+    entry.resident_base = entry.levels;
+    entry.wanted_level = entry.tail_level;
+    entry.last_used = _frame;
+
+    glGenTextures(1, &entry.id);
+    glBindTexture(GL_TEXTURE_2D, entry.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, desc.wrap_s);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, desc.wrap_t);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, entry.levels - 1);
+
+    _entries.push_back(entry);
+    const int handle = static_cast<int>(_entries.size()) - 1;
+    schedule(handle, entry.tail_level, entry.levels - 1);
+    return handle;
+}
+
+void TextureStreamer::report_screen_size(int handle, float pixels) {
+    Entry& entry = _entries[static_cast<std::size_t>(handle)];
+    const float texels = static_cast<float>(std::max(entry.width, entry.height));
+    const int level = pixels <= 0.0f ? entry.tail_level
+                                     : static_cast<int>(std::floor(std::log2(std::max(1.0f, texels / pixels))));
+
+    // several draws of one texture in a frame, the biggest one wins
+    if (entry.last_used != _frame) {
+        entry.wanted_level = entry.tail_level;
+        entry.last_used = _frame;
+    }
+    entry.wanted_level = std::clamp(std::min(entry.wanted_level, level), 0, entry.tail_level);
+}
+
+void TextureStreamer::update() {
+    std::vector<LoadedLevels> finished;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        finished.swap(_finished);
+    }
+    for (const auto& loaded: finished) {
+        upload(loaded);
+    }
+
+    enforce_budget();
+
+    for (std::size_t i = 0; i < _entries.size(); ++i) {
+        Entry& entry = _entries[i];
+        // only used textures, and only once the tail is in so the new levels land right above it
+        if (entry.pending_level == -1 && entry.last_used == _frame && entry.resident_base < entry.levels &&
+            entry.wanted_level < entry.resident_base) {
+            schedule(static_cast<int>(i), entry.wanted_level, entry.resident_base - 1);
+        }
+    }
+
+    ++_frame;
+}
+
+unsigned int TextureStreamer::texture(int handle) const {
+    const Entry& entry = _entries[static_cast<std::size_t>(handle)];
+    return entry.resident_base < entry.levels ? entry.id : _placeholder;
+}
+
+void TextureStreamer::bind(int handle, unsigned int unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, texture(handle));
+}
+
+int TextureStreamer::resident_level(int handle) const {
+    return _entries[static_cast<std::size_t>(handle)].resident_base;
+}
+
+std::size_t TextureStreamer::resident_bytes() const {
+    return _resident_bytes;
+}
+
+void TextureStreamer::schedule(int handle, int first_level, int last_level) {
+    Entry& entry = _entries[static_cast<std::size_t>(handle)];
+    entry.pending_level = first_level;
+    const Job job{handle, entry.path, entry.compressed, entry.flip_vertically, first_level, last_level};
+    _job_system.run(_loads, [this, job] {
+        load(job);
+    });
+}
+
+void TextureStreamer::load(const Job& job) {
+    if (_stopping) {
+        return;
+    }
+    LoadedLevels loaded{job.handle, job.first_level, {}};
+    if (!load_levels(job, loaded)) {
+        std::cerr << "ERROR::TEXTURE_STREAMER::FAILED_TO_LOAD: " << job.path << " levels " << job.first_level
+                  << "-" << job.last_level << std::endl;
+        loaded.levels.clear();
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _finished.push_back(std::move(loaded));
+}
+
+bool TextureStreamer::load_levels(const Job& job, LoadedLevels& out) {
+    const auto count = static_cast<std::size_t>(job.last_level - job.first_level + 1);
+
+    if (job.compressed) {
+        CompressedImage image;
+        if (!load_dds(job.path, image, job.first_level) || image.levels.size() < count) {
+            return false;
+        }
+        image.levels.resize(count);
+        out.levels = std::move(image.levels);
+        return true;
+    }
+
+    // stb can't decode a single mip, so the full image is decoded and halved down to the first level
+    Image image;
+    if (!load_image(job.path, image, job.flip_vertically)) {
+        return false;
+    }
+    for (int level = 0; level < job.first_level; ++level) {
+        image = half_size(image);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i != 0) {
+            image = half_size(image);
+        }
+        out.levels.push_back(image.pixels);
+    }
+    return true;
+}
+
+void TextureStreamer::upload(const LoadedLevels& loaded) {
+    Entry& entry = _entries[static_cast<std::size_t>(loaded.handle)];
+    entry.pending_level = -1;
+    if (loaded.levels.empty()) {
+        return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, entry.id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (std::size_t i = 0; i < loaded.levels.size(); ++i) {
+        const int level = loaded.first_level + static_cast<int>(i);
+        const int width = std::max(1, entry.width >> level);
+        const int height = std::max(1, entry.height >> level);
+        const auto& data = loaded.levels[i];
+
+        if (entry.compressed) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, entry.format.internal_format, width, height, 0,
+                                   static_cast<GLsizei>(data.size()), data.data());
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(entry.format.internal_format), width, height, 0,
+                         entry.format.format, GL_UNSIGNED_BYTE, data.data());
+        }
+        _resident_bytes += level_bytes(entry, level);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    entry.resident_base = loaded.first_level;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, entry.resident_base);
+}
+
+void TextureStreamer::evict_level(Entry& entry) {
+    const int level = entry.resident_base;
+
+    glBindTexture(GL_TEXTURE_2D, entry.id);
+    // clamp first, so the texture stays complete, then free the level by giving it a 0x0 size
+    entry.resident_base = level + 1;
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, entry.resident_base);
+    if (entry.compressed) {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, entry.format.internal_format, 0, 0, 0, 0, nullptr);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, level, static_cast<GLint>(entry.format.internal_format), 0, 0, 0,
+                     entry.format.format, GL_UNSIGNED_BYTE, nullptr);
+    }
+    _resident_bytes -= level_bytes(entry, level);
+}
+
+void TextureStreamer::enforce_budget() {
+    while (_resident_bytes > _budget) {
+        Entry* victim = nullptr;
+        for (auto& entry: _entries) {
+            // never below the tail, never under a load in flight, and textures used this frame
+            // only give up detail they don't need anymore
+            const bool evictable = entry.resident_base < entry.tail_level && entry.pending_level == -1 &&
+                                   (entry.last_used != _frame || entry.resident_base < entry.wanted_level);
+            if (evictable && (victim == nullptr || entry.last_used < victim->last_used)) {
+                victim = &entry;
+            }
+        }
+        if (victim == nullptr) {
+            // everything left is on screen, going over the budget beats showing blurry textures
+            return;
+        }
+        evict_level(*victim);
+    }
+}
+
+std::size_t TextureStreamer::level_bytes(const Entry& entry, int level) const {
+    const auto width = static_cast<std::size_t>(std::max(1, entry.width >> level));
+    const auto height = static_cast<std::size_t>(std::max(1, entry.height >> level));
+    if (entry.compressed) {
+        return ((width + 3) / 4) * ((height + 3) / 4) * static_cast<std::size_t>(block_bytes(entry.block_format));
+    }
+    return width * height * static_cast<std::size_t>(entry.channels);
+}
+
+} // tools
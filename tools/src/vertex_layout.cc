@@ -0,0 +1,70 @@
+#include "tools/vertex_layout.h"
+
+namespace tools {
+
+GLuint attribute_type_size(GLenum type) {
+    switch (type) {
+        case GL_BYTE:
+        case GL_UNSIGNED_BYTE:
+            return 1;
+        case GL_SHORT:
+        case GL_UNSIGNED_SHORT:
+        case GL_HALF_FLOAT:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+VertexLayout& VertexLayout::add(GLuint location, GLint components, GLenum type, bool normalized) {
+    _attributes.push_back({location, components, type, static_cast<GLboolean>(normalized ? GL_TRUE : GL_FALSE), _stride});
+    _stride += static_cast<GLuint>(components) * attribute_type_size(type);
+    return *this;
+}
+
+VertexLayout& VertexLayout::pad(GLuint bytes) {
+    _stride += bytes;
+    return *this;
+}
+
+void VertexLayout::apply(GLintptr base_offset) const {
+    for (const VertexAttribute& attribute: _attributes) {
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized,
+                              static_cast<GLsizei>(_stride), (void*) (base_offset + attribute.offset));
+        glEnableVertexAttribArray(attribute.location);
+    }
+}
+
+void VertexLayout::apply_format(GLuint binding) const {
+    for (const VertexAttribute& attribute: _attributes) {
+        glVertexAttribFormat(attribute.location, attribute.components, attribute.type, attribute.normalized,
+                             attribute.offset);
+        glVertexAttribBinding(attribute.location, binding);
+        glEnableVertexAttribArray(attribute.location);
+    }
+}
+
+GLsizei VertexLayout::stride() const {
+    return static_cast<GLsizei>(_stride);
+}
+
+const std::vector<VertexAttribute>& VertexLayout::attributes() const {
+    return _attributes;
+}
+
+bool VertexLayout::operator==(const VertexLayout& other) const {
+    if (_stride != other._stride || _attributes.size() != other._attributes.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < _attributes.size(); ++i) {
+        const VertexAttribute& a = _attributes[i];
+        const VertexAttribute& b = other._attributes[i];
+        if (a.location != b.location || a.components != b.components || a.type != b.type ||
+            a.normalized != b.normalized || a.offset != b.offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // tools
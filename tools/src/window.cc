@@ -3,14 +3,44 @@
 
 namespace tools {
 
-void framebuffer_size_callback(GLFWwindow*, int width, int height) {
-    glViewport(0, 0, width, height);
+void Window::framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    auto* self = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    self->_input.push({InputEventType::resize, 0, 0, 0, static_cast<double>(width), static_cast<double>(height)});
+    if (glfwGetCurrentContext() == window) {
+        glViewport(0, 0, width, height);
+        return;
+    }
+    // no GL without the context, the thread that has it picks the size up in update_viewport
+    self->_pending_viewport.store(static_cast<std::uint64_t>(width) << 32 | static_cast<std::uint32_t>(height));
+}
+
+void Window::key_callback(GLFWwindow* window, int key, int, int action, int mods) {
+    auto* self = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    self->_input.push({InputEventType::key, static_cast<std::uint8_t>(action), static_cast<std::uint16_t>(mods),
+                       key, 0.0, 0.0});
+}
+
+void Window::mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    auto* self = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    self->_input.push({InputEventType::mouse_button, static_cast<std::uint8_t>(action),
+                       static_cast<std::uint16_t>(mods), button, 0.0, 0.0});
+}
+
+void Window::cursor_position_callback(GLFWwindow* window, double x, double y) {
+    auto* self = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    self->_input.push({InputEventType::cursor, 0, 0, 0, x, y});
+}
+
+void Window::scroll_callback(GLFWwindow* window, double x, double y) {
+    auto* self = static_cast<Window*>(glfwGetWindowUserPointer(window));
+    self->_input.push({InputEventType::scroll, 0, 0, 0, x, y});
 }
 
-Window::Window(int height, int width, const std::string& window_name) {
+Window::Window(int height, int width, const std::string& window_name, int gl_major, int gl_minor)
+        : _gl_major(gl_major), _gl_minor(gl_minor) {
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, gl_major);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, gl_minor);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     _window = glfwCreateWindow(width, height, window_name.c_str(), nullptr, nullptr);
@@ -27,11 +57,18 @@ Window::Window(int height, int width, const std::string& window_name) {
         glfwTerminate();
     }
 
+    glfwSetWindowUserPointer(_window, this);
     glfwSetFramebufferSizeCallback(_window, framebuffer_size_callback);
+    glfwSetKeyCallback(_window, key_callback);
+    glfwSetMouseButtonCallback(_window, mouse_button_callback);
+    glfwSetCursorPosCallback(_window, cursor_position_callback);
+    glfwSetScrollCallback(_window, scroll_callback);
 
 }
 
 Window::~Window() {
+    // the ring's buffers need the context, which goes away with glfwTerminate
+    stop_capture();
     glfwTerminate();
 }
 
@@ -39,10 +76,39 @@ void Window::make_current() {
     glfwMakeContextCurrent(_window);
 }
 
+GLFWwindow* Window::create_shared_context() {
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, _gl_major);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, _gl_minor);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* context = glfwCreateWindow(1, 1, "", nullptr, _window);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+    if (context == nullptr) {
+        std::cerr << "ERROR::WINDOW::FAILED_TO_CREATE_SHARED_CONTEXT" << std::endl;
+    }
+    return context;
+}
+
+void Window::destroy_shared_context(GLFWwindow* context) {
+    glfwDestroyWindow(context);
+}
+
 GLFWwindow* Window::operator~() {
     return _window;
 }
 
+Input& Window::input() {
+    return _input;
+}
+
+const Input& Window::input() const {
+    return _input;
+}
+
+void Window::close() {
+    glfwSetWindowShouldClose(_window, GLFW_TRUE);
+}
+
 bool Window::should_close() const {
     return glfwWindowShouldClose(_window);
 }
@@ -51,9 +117,66 @@ void Window::poll_events() {
     glfwPollEvents();
 }
 
+void Window::update_viewport() {
+    const std::uint64_t size = _pending_viewport.exchange(0);
+    if (size != 0) {
+        glViewport(0, 0, static_cast<GLsizei>(size >> 32), static_cast<GLsizei>(size & 0xffffffff));
+    }
+}
+
 void Window::swap_buffers() {
+    if (_capture) {
+        capture_frame();
+    }
     glfwSwapBuffers(_window);
 }
 
+bool Window::start_capture(const ExportDesc& desc) {
+    stop_capture();
+
+    int width, height;
+    glfwGetFramebufferSize(_window, &width, &height);
+    _exporter = std::make_unique<FrameExporter>(desc);
+    if (!_exporter->ok()) {
+        _exporter.reset();
+        return false;
+    }
+    // three frames in flight is about as far as drivers let the GPU run behind anyway
+    _capture = std::make_unique<FrameCapture>(width, height, 3);
+    return true;
+}
+
+bool Window::stop_capture() {
+    if (!_capture) {
+        return true;
+    }
+    Image frame;
+    while (_capture->wait(frame)) {
+        _exporter->submit(std::move(frame));
+    }
+    _exporter->finish();
+    const bool ok = _exporter->ok();
+    _capture.reset();
+    _exporter.reset();
+    return ok;
+}
+
+bool Window::capturing() const {
+    return _capture != nullptr;
+}
+
+void Window::capture_frame() {
+    Image frame;
+    while (_capture->poll(frame)) {
+        _exporter->submit(std::move(frame));
+    }
+    // every slot still in flight, the GPU is a whole ring behind. waiting is the only way not to drop a frame
+    if (!_capture->request()) {
+        _capture->wait(frame);
+        _exporter->submit(std::move(frame));
+        _capture->request();
+    }
+}
+
 
 } // tools
\ No newline at end of file